@@ -5,14 +5,23 @@
 #include "data_manager.h"
 #include "file_utils.h"
 #include "video_list.h"
+#include "history.h"
+#include "mpv_import.h"
+#include "snapshot.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <ctype.h>
+#include <limits.h>
+#include <time.h>
 
-#define DATA_FILE ".mirava_data.json"
+#define MIRAVA_FILE_PREFIX ".mirava"
+
+#ifdef _WIN32
+#define realpath(path, resolved) _fullpath((resolved), (path), PATH_MAX)
+#endif
 
 // Helper function to get relative path from course root
 static const char* get_relative_path(const char *full_path, const char *course_root)
@@ -37,6 +46,24 @@ static const char* get_relative_path(const char *full_path, const char *course_r
     return full_path;
 }
 
+// A catalog entry whose size and mtime still match the file on disk keeps its
+// probed duration, chapters and fingerprint; only changed files are probed.
+static int is_probe_current(const VideoInfo *vid, const struct stat *statbuf)
+{
+    return vid->duration_sec >= 0 && vid->fingerprint[0] &&
+           vid->file_size == (long long)statbuf->st_size &&
+           vid->mtime == (long long)statbuf->st_mtime;
+}
+
+static void probe_video_file(VideoInfo *vid, const char *full_path, const struct stat *statbuf)
+{
+    free_chapter_table(&vid->chapters);
+    vid->duration_sec = get_duration_in_seconds(full_path, &vid->chapters);
+    vid->file_size = (long long)statbuf->st_size;
+    vid->mtime = (long long)statbuf->st_mtime;
+    compute_file_fingerprint(full_path, vid->fingerprint);
+}
+
 // --- Private function for scanning filesystem ---
 static void scan_and_sync_videos(const char *basePath)
 {
@@ -58,8 +85,8 @@ static void scan_and_sync_videos(const char *basePath)
         // Get relative path from course root
         const char *display_path = get_relative_path(full_path, course_root);
         
-        // Skip the JSON data file
-        if (strcmp(dp->d_name, DATA_FILE) == 0)
+        // Skip the catalog, the per-user progress directory and other mirava files
+        if (strncmp(dp->d_name, MIRAVA_FILE_PREFIX, strlen(MIRAVA_FILE_PREFIX)) == 0)
             continue;
 
         struct stat statbuf;
@@ -75,17 +102,19 @@ static void scan_and_sync_videos(const char *basePath)
                 if (existing_video)
                 {
                     existing_video->found_on_disk = 1;
-                    existing_video->duration_sec = get_duration_in_seconds(full_path);
+                    if (!is_probe_current(existing_video, &statbuf))
+                    {
+                        probe_video_file(existing_video, full_path, &statbuf);
+                    }
                 }
                 else
                 {
-                    VideoInfo *new_video = malloc(sizeof(VideoInfo));
+                    VideoInfo *new_video = create_video_info(display_path);
                     if (new_video)
                     {
-                        new_video->path = strdup(display_path);
-                        new_video->duration_sec = get_duration_in_seconds(full_path);
-                        new_video->watched_sec = 0;
+                        new_video->id = allocate_entry_id();
                         new_video->found_on_disk = 1;
+                        probe_video_file(new_video, full_path, &statbuf);
                         add_video_to_list(new_video);
                     }
                 }
@@ -95,13 +124,62 @@ static void scan_and_sync_videos(const char *basePath)
     closedir(dir);
 }
 
-void action_list_and_sync()
+// Turns the --dir of the listing options, given relative to the current
+// directory, into a directory relative to the course root ("" for the root).
+// Returns 0 and reports the problem if it is not a directory of the course.
+static int resolve_list_dir(ListOptions *options, char *buffer, size_t size)
+{
+    if (!options->dir)
+        return 1;
+
+    char root[PATH_MAX];
+    char dir[PATH_MAX];
+    const char *course_root = get_course_root_dir();
+    if (!realpath(course_root ? course_root : ".", root) || !realpath(options->dir, dir))
+    {
+        fprintf(stderr, "Error: Directory '%s' not found.\n", options->dir);
+        return 0;
+    }
+
+    size_t root_length = strlen(root);
+    if (strcmp(dir, root) == 0)
+    {
+        buffer[0] = '\0';
+    }
+    else if (strncmp(dir, root, root_length) == 0 && (dir[root_length] == '/' || root[root_length - 1] == '/'))
+    {
+        const char *relative = dir + root_length;
+        if (*relative == '/')
+            relative++;
+        snprintf(buffer, size, "%s", relative);
+    }
+    else
+    {
+        fprintf(stderr, "Error: Directory '%s' is not inside the course at '%s'.\n", options->dir, root);
+        return 0;
+    }
+
+    options->dir = buffer;
+    return 1;
+}
+
+void action_list_and_sync(const ListOptions *options)
 {
     load_data_from_json();
 
+    ListOptions resolved = *options;
+    char dir[PATH_MAX];
+    if (!resolve_list_dir(&resolved, dir, sizeof(dir)))
+        return;
+    options = &resolved;
+
     if (!g_course_name)
     {
-        prompt_for_course_name();
+        // Machine-readable output must not be mixed with an interactive prompt
+        if (options->format == FORMAT_HUMAN)
+            prompt_for_course_name();
+        else
+            set_default_course_name();
     }
 
     // Get the course root directory and scan from there
@@ -114,14 +192,48 @@ void action_list_and_sync()
     
     prune_missing_videos();
 
-    display_video_list();
+    display_video_list(options);
     save_data_to_json();
-    printf("\nData synced and saved successfully.\n");
+    if (options->format == FORMAT_HUMAN)
+    {
+        printf("\nData synced and saved successfully.\n");
+    }
 }
 
-static long long parse_progress_string(const char *progress_str, long long total_duration)
+void action_list_cached(const ListOptions *options)
 {
-    if (strchr(progress_str, '%'))
+    load_data_from_json();
+
+    ListOptions resolved = *options;
+    char dir[PATH_MAX];
+    if (resolve_list_dir(&resolved, dir, sizeof(dir)))
+    {
+        display_video_list(&resolved);
+    }
+}
+
+// Parses a progress value for a video. Returns -1 for an invalid format and
+// -2 for a chapter the video does not have (already reported).
+static long long parse_progress_string(const char *progress_str, const VideoInfo *vid)
+{
+    long long total_duration = vid->duration_sec;
+
+    if (strncmp(progress_str, "ch:", 3) == 0)
+    {
+        // "ch:N" means watched through the end of chapter N
+        const char *number = progress_str + 3;
+        if (*number == '\0' || strspn(number, "0123456789") != strlen(number))
+            return -1;
+
+        long long chapter = atoll(number);
+        if (chapter < 1 || (size_t)chapter > vid->chapters.count)
+        {
+            fprintf(stderr, "Error: Video '%s' has no chapter %lld (it has %zu).\n", vid->path, chapter, vid->chapters.count);
+            return -2;
+        }
+        return vid->chapters.items[chapter - 1].end_sec;
+    }
+    else if (strchr(progress_str, '%'))
     {
         int percentage = atoi(progress_str);
         if (percentage >= 0 && percentage <= 100)
@@ -162,21 +274,131 @@ void action_update_progress(int video_number, const char *progress_str)
     }
 
     VideoInfo *vid = g_video_list[video_number - 1];
-    long long new_watched_sec = parse_progress_string(progress_str, vid->duration_sec);
+    long long new_watched_sec = parse_progress_string(progress_str, vid);
 
     if (new_watched_sec < 0)
     {
-        fprintf(stderr, "Error: Invalid progress format: '%s'.\n", progress_str);
+        if (new_watched_sec == -1)
+            fprintf(stderr, "Error: Invalid progress format: '%s'.\n", progress_str);
         return;
     }
 
+    long long old_watched_sec = vid->watched_sec;
     vid->watched_sec = (vid->duration_sec > 0 && new_watched_sec > vid->duration_sec) ? vid->duration_sec : new_watched_sec;
-    save_data_to_json();
+    vid->updated_at = (long long)time(NULL);
+    record_progress_event(vid, old_watched_sec);
+    if (!save_progress_to_json())
+        return;
     printf("Updated video %d ('%s') to %lld seconds.\n", video_number, vid->path, vid->watched_sec);
 }
 
+void action_show_chapters(int video_number)
+{
+    load_data_from_json();
+    if (video_number <= 0 || (size_t)video_number > g_video_count)
+    {
+        fprintf(stderr, "Error: Invalid video number: %d. Must be between 1 and %zu.\n", video_number, g_video_count);
+        return;
+    }
+
+    display_chapter_list(video_number);
+}
+
+void action_import_mpv(const char *watch_later_dir)
+{
+    char default_dir[PATH_MAX];
+    if (!watch_later_dir)
+    {
+        if (!find_mpv_watch_later_dir(default_dir, sizeof(default_dir)))
+        {
+            fprintf(stderr, "Error: Could not find mpv's watch_later directory. Pass it as an argument.\n");
+            return;
+        }
+        watch_later_dir = default_dir;
+    }
+
+    load_data_from_json();
+    const char *course_root = get_course_root_dir();
+    long updated = import_mpv_positions(watch_later_dir, course_root ? course_root : ".");
+    if (updated < 0)
+    {
+        fprintf(stderr, "Error: Could not read mpv watch_later directory '%s'.\n", watch_later_dir);
+        return;
+    }
+
+    if (updated > 0)
+    {
+        if (!save_progress_to_json())
+            return;
+    }
+    printf("Imported %ld resume position%s from '%s'.\n", updated, updated == 1 ? "" : "s", watch_later_dir);
+}
+
+void action_export_progress(const char *output_path)
+{
+    load_data_from_json();
+
+    int to_stdout = !output_path || strcmp(output_path, "-") == 0;
+    FILE *out = to_stdout ? stdout : fopen(output_path, "w");
+    if (!out)
+    {
+        fprintf(stderr, "Error: Could not open '%s' for writing.\n", output_path);
+        return;
+    }
+
+    int ok = export_snapshot(out);
+    if (!to_stdout && fclose(out) != 0)
+        ok = 0;
+    if (!ok)
+    {
+        fprintf(stderr, "Error: Failed to write snapshot.\n");
+    }
+    else if (!to_stdout)
+    {
+        printf("Exported progress of %zu videos to '%s'.\n", g_video_count, output_path);
+    }
+}
+
+void action_import_progress(const char *snapshot_path, const char *policy_name)
+{
+    MergePolicy policy = MERGE_MAX_WATCHED;
+    if (policy_name && strcmp(policy_name, "lww") == 0)
+    {
+        policy = MERGE_LAST_WRITER_WINS;
+    }
+    else if (policy_name && strcmp(policy_name, "max") != 0)
+    {
+        fprintf(stderr, "Error: Unknown merge policy '%s'. Use 'max' or 'lww'.\n", policy_name);
+        return;
+    }
+
+    load_data_from_json();
+    MergeReport report;
+    if (!merge_snapshot(snapshot_path, policy, &report))
+    {
+        fprintf(stderr, "Error: Could not read snapshot '%s'.\n", snapshot_path);
+        return;
+    }
+
+    if (report.updated > 0)
+    {
+        if (!save_progress_to_json())
+            return;
+    }
+    printf("Merged %zu of %zu snapshot entries (%zu by path, %zu by fingerprint); %zu videos updated.\n",
+           report.matched_by_path + report.matched_by_fingerprint, report.entries,
+           report.matched_by_path, report.matched_by_fingerprint, report.updated);
+}
+
+void action_show_stats()
+{
+    load_data_from_json();
+    display_watch_stats();
+}
+
 void cleanup_globals()
 {
+    close_history_log();
     cleanup_video_list();
     cleanup_course_root();
     free(g_course_name);
@@ -1,12 +1,34 @@
 #ifndef ACTIONS_H
 #define ACTIONS_H
 
+#include "cli.h"
+
 // The default action: syncs filesystem, lists videos, and saves.
-void action_list_and_sync();
+void action_list_and_sync(const ListOptions *options);
+
+// Lists videos from the saved data without scanning or probing files.
+void action_list_cached(const ListOptions *options);
 
 // Updates a video's watched time and saves the result.
 void action_update_progress(int video_number, const char* progress_str);
 
+// Shows the cached chapter table of a video with per-chapter progress.
+void action_show_chapters(int video_number);
+
+// Imports resume positions from mpv's watch_later files and saves them.
+// Uses the default mpv location if watch_later_dir is NULL.
+void action_import_mpv(const char *watch_later_dir);
+
+// Writes the current progress as a snapshot to a file, or stdout if NULL or "-".
+void action_export_progress(const char *output_path);
+
+// Merges a progress snapshot into the current progress and saves it.
+// policy_name is "max" (default when NULL) or "lww".
+void action_import_progress(const char *snapshot_path, const char *policy_name);
+
+// Shows watch pace, streaks and the projected completion date.
+void action_show_stats();
+
 // Frees all global resources.
 void cleanup_globals();
 
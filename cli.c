@@ -1,64 +1,551 @@
 #define _DEFAULT_SOURCE
 #include "cli.h"
 #include "globals.h" // Use the centralized global declarations
+#include "history.h"
+#include "output_buffer.h"
+#include "video_list.h"
+#include <jansson.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <time.h>
+#ifndef _WIN32
+#include <sys/ioctl.h>
+#endif
 
-void display_video_list()
+// Narrowest path column used when the terminal is too small for full paths
+#define MIN_PATH_COLUMN 20
+
+// Width of the title column in chapter lists
+#define CHAPTER_TITLE_COLUMN 40
+
+// Completion state of a video, shared by all output formats
+typedef enum {
+    STATUS_UNWATCHED,
+    STATUS_PARTIAL,
+    STATUS_COMPLETE
+} WatchStatus;
+
+static const char *status_names[] = { "unwatched", "partial", "complete" };
+
+// Gets the status of a video and its percentage (-1 if the duration is unknown)
+static WatchStatus get_watch_status(const VideoInfo *vid, int *percentage)
+{
+    *percentage = -1;
+    if (vid->duration_sec > 0)
+    {
+        if (vid->watched_sec >= vid->duration_sec)
+        {
+            *percentage = 100;
+            return STATUS_COMPLETE;
+        }
+        *percentage = (int)(100 * vid->watched_sec / vid->duration_sec);
+        return vid->watched_sec > 0 ? STATUS_PARTIAL : STATUS_UNWATCHED;
+    }
+
+    // For videos with unknown duration, check if they are marked as watched
+    if (vid->watched_sec >= 999999) // Our arbitrary "complete" value
+        return STATUS_COMPLETE;
+    return vid->watched_sec > 0 ? STATUS_PARTIAL : STATUS_UNWATCHED;
+}
+
+static int is_video_listed(const VideoInfo *vid, const ListOptions *options)
+{
+    int percentage;
+    if (options->unfinished_only && get_watch_status(vid, &percentage) == STATUS_COMPLETE)
+        return 0;
+
+    // dir is relative to the course root; "" is the root itself
+    if (options->dir && options->dir[0])
+    {
+        size_t length = strlen(options->dir);
+        if (strncmp(vid->path, options->dir, length) != 0 || vid->path[length] != '/')
+            return 0;
+    }
+    return 1;
+}
+
+// Terminal columns taken by a UTF-8 string, counting one per code point
+static size_t display_width(const char *text)
+{
+    size_t width = 0;
+    for (; *text; text++)
+    {
+        if (((unsigned char)*text & 0xC0) != 0x80)
+            width++;
+    }
+    return width;
+}
+
+// Returns the suffix of text that spans its last `columns` code points
+static const char* last_columns(const char *text, size_t columns)
+{
+    const char *p = text + strlen(text);
+    while (p > text && columns > 0)
+    {
+        p--;
+        if (((unsigned char)*p & 0xC0) != 0x80)
+            columns--;
+    }
+    return p;
+}
+
+// Returns the end of the prefix of text that spans its first `columns` code points
+static const char* first_columns(const char *text, size_t columns)
+{
+    const char *p = text;
+    while (*p)
+    {
+        if (((unsigned char)*p & 0xC0) != 0x80)
+        {
+            if (columns == 0)
+                break;
+            columns--;
+        }
+        p++;
+    }
+    return p;
+}
+
+// Gets the width of the terminal, or 0 when output is not a terminal and
+// lines should never be truncated
+static size_t get_terminal_width()
+{
+#ifdef TIOCGWINSZ
+    struct winsize ws;
+    if (isatty(STDOUT_FILENO) && ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0)
+        return ws.ws_col;
+#endif
+    if (!isatty(STDOUT_FILENO))
+        return 0;
+
+    const char *columns = getenv("COLUMNS");
+    if (columns && atoi(columns) > 0)
+        return (size_t)atoi(columns);
+    return 80;
+}
+
+static void append_repeated(OutputBuffer *out, char c, size_t count)
 {
-    printf("\n--- Course: %s ---\n", g_course_name ? g_course_name : "N/A");
+    char chunk[64];
+    memset(chunk, c, sizeof(chunk));
+    while (count > 0)
+    {
+        size_t n = count < sizeof(chunk) ? count : sizeof(chunk);
+        outbuf_append(out, chunk, n);
+        count -= n;
+    }
+}
+
+static void render_human(OutputBuffer *out, const ListOptions *options)
+{
+    outbuf_printf(out, "\n--- Course: %s ---\n", g_course_name ? g_course_name : "N/A");
+
+    // Size the path column to the longest listed path, within the terminal
+    size_t number_width = 2;
+    for (size_t n = g_video_count; n >= 100; n /= 10)
+        number_width++;
+
+    size_t path_width = 0;
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        if (is_video_listed(g_video_list[i], options))
+        {
+            size_t width = display_width(g_video_list[i]->path);
+            if (width > path_width)
+                path_width = width;
+        }
+    }
+
+    // "NN. " + path + " [HH:MM:SS] " + "[watched]"
+    size_t fixed_width = number_width + 2 + 1 + 10 + 1 + 9;
+    size_t terminal_width = get_terminal_width();
+    if (terminal_width > 0 && path_width + fixed_width > terminal_width)
+    {
+        path_width = (terminal_width > fixed_width + MIN_PATH_COLUMN) ? terminal_width - fixed_width : MIN_PATH_COLUMN;
+    }
+
     long long total_duration = 0;
     long long total_watched = 0;
 
     for (size_t i = 0; i < g_video_count; i++)
     {
         VideoInfo *vid = g_video_list[i];
-        total_duration += vid->duration_sec;
-        total_watched += vid->watched_sec;
+        if (!is_video_listed(vid, options))
+            continue;
 
-        char status_str[15] = "";
         if (vid->duration_sec > 0)
         {
-            if (vid->watched_sec >= vid->duration_sec)
-            {
-                snprintf(status_str, sizeof(status_str), "[✓]");
-            }
-            else if (vid->watched_sec > 0)
-            {
-                int percentage = (int)(100 * vid->watched_sec / vid->duration_sec);
+            total_duration += vid->duration_sec;
+            total_watched += vid->watched_sec;
+        }
+
+        int percentage;
+        char status_str[15] = "";
+        switch (get_watch_status(vid, &percentage))
+        {
+        case STATUS_COMPLETE:
+            snprintf(status_str, sizeof(status_str), "[✓]");
+            break;
+        case STATUS_PARTIAL:
+            if (percentage >= 0)
                 snprintf(status_str, sizeof(status_str), "[%d%%]", percentage);
-            }
+            else
+                snprintf(status_str, sizeof(status_str), "[watched]");
+            break;
+        case STATUS_UNWATCHED:
+            break;
+        }
+
+        // Long paths keep their tail, which holds the file name
+        const char *path = vid->path;
+        size_t width = display_width(path);
+        outbuf_printf(out, "%*zu. ", (int)number_width, i + 1);
+        if (width > path_width)
+        {
+            outbuf_append(out, "...", 3);
+            path = last_columns(path, path_width - 3);
+            width = path_width;
+        }
+        outbuf_append(out, path, strlen(path));
+        append_repeated(out, ' ', path_width - width);
+
+        if (vid->duration_sec >= 0)
+        {
+            outbuf_printf(out, " [%02lld:%02lld:%02lld] %s\n", vid->duration_sec / 3600,
+                          (vid->duration_sec % 3600) / 60, vid->duration_sec % 60, status_str);
         }
         else
         {
-            // For videos with unknown duration, check if they are marked as watched
-            if (vid->watched_sec >= 999999) // Our arbitrary "complete" value
-            {
-                snprintf(status_str, sizeof(status_str), "[✓]");
-            }
-            else if (vid->watched_sec > 0)
+            outbuf_printf(out, " [--:--:--] %s\n", status_str);
+        }
+    }
+
+    append_repeated(out, '-', number_width + 2 + path_width + 12);
+    outbuf_append(out, "\n", 1);
+    if (total_duration > 0)
+    {
+        int overall_percent = (int)(100 * total_watched / total_duration);
+        outbuf_printf(out, "Total Duration: %lld:%02lld:%02lld  |  Overall Progress: %d%%\n",
+                      total_duration / 3600, (total_duration % 3600) / 60, total_duration % 60, overall_percent);
+    }
+}
+
+// Appends a TSV field, escaping backslashes, tabs and newlines
+static void append_tsv_field(OutputBuffer *out, const char *text)
+{
+    const char *start = text;
+    for (; *text; text++)
+    {
+        const char *escape = NULL;
+        if (*text == '\\')
+            escape = "\\\\";
+        else if (*text == '\t')
+            escape = "\\t";
+        else if (*text == '\n')
+            escape = "\\n";
+        else if (*text == '\r')
+            escape = "\\r";
+
+        if (escape)
+        {
+            outbuf_append(out, start, (size_t)(text - start));
+            outbuf_append(out, escape, 2);
+            start = text + 1;
+        }
+    }
+    outbuf_append(out, start, (size_t)(text - start));
+}
+
+static void render_tsv(OutputBuffer *out, const ListOptions *options)
+{
+    outbuf_printf(out, "number\tpath\tduration_sec\twatched_sec\tpercent\tstatus\n");
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        VideoInfo *vid = g_video_list[i];
+        if (!is_video_listed(vid, options))
+            continue;
+
+        int percentage;
+        WatchStatus status = get_watch_status(vid, &percentage);
+        outbuf_printf(out, "%zu\t", i + 1);
+        append_tsv_field(out, vid->path);
+        outbuf_printf(out, "\t%lld\t%lld\t%d\t%s\n", vid->duration_sec, vid->watched_sec,
+                      percentage, status_names[status]);
+    }
+}
+
+// Makes a JSON string of text, which jansson requires to be valid UTF-8.
+// File and course names may not be, so invalid bytes become U+FFFD rather
+// than the entry being left out.
+static json_t* json_text(const char *text)
+{
+    json_t *string = json_string(text);
+    if (!string)
+    {
+        char *valid = copy_as_utf8(text, 0);
+        if (valid)
+        {
+            string = json_string(valid);
+            free(valid);
+        }
+    }
+    return string;
+}
+
+// Returns 0 if the listing could not be built
+static int render_json(OutputBuffer *out, const ListOptions *options)
+{
+    long long total_duration = 0;
+    long long total_watched = 0;
+    json_t *videos_array = json_array();
+
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        VideoInfo *vid = g_video_list[i];
+        if (!is_video_listed(vid, options))
+            continue;
+
+        if (vid->duration_sec > 0)
+        {
+            total_duration += vid->duration_sec;
+            total_watched += vid->watched_sec;
+        }
+
+        int percentage;
+        WatchStatus status = get_watch_status(vid, &percentage);
+        // Same fields as the TSV rows; percent is -1 when the duration is unknown
+        json_t *video_obj = json_pack("{s:I, s:o, s:I, s:I, s:i, s:s}",
+                                      "number", (json_int_t)(i + 1),
+                                      "path", json_text(vid->path),
+                                      "duration_sec", (json_int_t)vid->duration_sec,
+                                      "watched_sec", (json_int_t)vid->watched_sec,
+                                      "percent", percentage,
+                                      "status", status_names[status]);
+        if (!video_obj || json_array_append_new(videos_array, video_obj) != 0)
+        {
+            json_decref(videos_array);
+            return 0;
+        }
+    }
+
+    json_t *root = json_pack("{s:o, s:I, s:I, s:o}",
+                             "course_name", json_text(g_course_name ? g_course_name : ""),
+                             "total_duration_sec", (json_int_t)total_duration,
+                             "total_watched_sec", (json_int_t)total_watched,
+                             "videos", videos_array);
+    char *text = root ? json_dumps(root, JSON_COMPACT) : NULL;
+    json_decref(root);
+    if (!text)
+        return 0;
+
+    outbuf_append(out, text, strlen(text));
+    outbuf_append(out, "\n", 1);
+    free(text);
+    return 1;
+}
+
+int parse_list_options(int argc, char *argv[], int first, ListOptions *options)
+{
+    options->format = FORMAT_HUMAN;
+    options->unfinished_only = 0;
+    options->dir = NULL;
+
+    for (int i = first; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--unwatched") == 0)
+        {
+            options->unfinished_only = 1;
+        }
+        else if ((strcmp(argv[i], "--format") == 0 || strcmp(argv[i], "--dir") == 0) && i + 1 >= argc)
+        {
+            fprintf(stderr, "Error: '%s' requires a value.\n", argv[i]);
+            return 0;
+        }
+        else if (strcmp(argv[i], "--format") == 0)
+        {
+            const char *format = argv[++i];
+            if (strcmp(format, "json") == 0)
+                options->format = FORMAT_JSON;
+            else if (strcmp(format, "tsv") == 0)
+                options->format = FORMAT_TSV;
+            else if (strcmp(format, "human") == 0)
+                options->format = FORMAT_HUMAN;
+            else
             {
-                snprintf(status_str, sizeof(status_str), "[watched]");
+                fprintf(stderr, "Error: Unknown format '%s'. Use 'json' or 'tsv'.\n", format);
+                return 0;
             }
         }
+        else if (strcmp(argv[i], "--dir") == 0)
+        {
+            options->dir = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "Error: Unknown option '%s'.\n", argv[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
 
-        int h = vid->duration_sec / 3600;
-        int m = (vid->duration_sec % 3600) / 60;
-        int s = vid->duration_sec % 60;
-        printf("%2zu. %-50s [%02d:%02d:%02d] %s\n", i + 1, vid->path, h, m, s, status_str);
+void display_video_list(const ListOptions *options)
+{
+    // The whole listing is built in memory and written with a single write()
+    OutputBuffer out = { 0 };
+
+    switch (options->format)
+    {
+    case FORMAT_JSON:
+        if (!render_json(&out, options))
+        {
+            fprintf(stderr, "Error: Failed to build the JSON video list.\n");
+            outbuf_free(&out);
+            return;
+        }
+        break;
+    case FORMAT_TSV:
+        render_tsv(&out, options);
+        break;
+    case FORMAT_HUMAN:
+        render_human(&out, options);
+        break;
     }
 
-    printf("---------------------------------------------------------------------\n");
-    if (total_duration > 0)
+    if (!outbuf_write(&out, STDOUT_FILENO))
     {
-        int h = total_duration / 3600;
-        int m = (total_duration % 3600) / 60;
-        int s = total_duration % 60;
-        int overall_percent = (int)(100 * total_watched / total_duration);
-        printf("Total Duration: %d:%02d:%02d  |  Overall Progress: %d%%\n", h, m, s, overall_percent);
+        fprintf(stderr, "Error: Failed to write video list.\n");
+    }
+    outbuf_free(&out);
+}
+
+// Formats a number of seconds as H:MM:SS
+static void format_hms(char *buffer, size_t size, long long seconds)
+{
+    snprintf(buffer, size, "%lld:%02lld:%02lld", seconds / 3600, (seconds % 3600) / 60, seconds % 60);
+}
+
+void display_watch_stats()
+{
+    long long today = day_number_from_time(time(NULL));
+    WatchSummary summary;
+    summarize_watch_stats(today, &summary);
+
+    long long remaining = 0;
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        VideoInfo *vid = g_video_list[i];
+        if (vid->duration_sec > 0 && vid->watched_sec < vid->duration_sec)
+        {
+            remaining += vid->duration_sec - vid->watched_sec;
+        }
+    }
+
+    char today_str[32], window_str[32], pace_str[32], total_str[32], remaining_str[32];
+    format_hms(today_str, sizeof(today_str), summary.today_sec);
+    format_hms(window_str, sizeof(window_str), summary.window_sec);
+    format_hms(pace_str, sizeof(pace_str), summary.pace_sec);
+    format_hms(total_str, sizeof(total_str), summary.total_sec);
+    format_hms(remaining_str, sizeof(remaining_str), remaining);
+
+    printf("\n--- Stats: %s ---\n", g_course_name ? g_course_name : "N/A");
+    printf("Watched today:        %s\n", today_str);
+    printf("Last %d days:          %s\n", PACE_WINDOW_DAYS, window_str);
+    printf("Average pace:         %s per day\n", pace_str);
+    printf("Total logged:         %s\n", total_str);
+    printf("Current streak:       %d day%s\n", summary.current_streak, summary.current_streak == 1 ? "" : "s");
+    printf("Longest streak:       %d day%s\n", summary.longest_streak, summary.longest_streak == 1 ? "" : "s");
+    printf("Remaining:            %s\n", remaining_str);
+
+    if (remaining == 0)
+    {
+        printf("Projected completion: course complete!\n");
+    }
+    else if (summary.pace_sec > 0)
+    {
+        long long days_left = (remaining + summary.pace_sec - 1) / summary.pace_sec;
+        int year, month, mday;
+        date_from_day_number(today + days_left, &year, &month, &mday);
+        printf("Projected completion: %04d-%02d-%02d (%lld day%s)\n",
+               year, month, mday, days_left, days_left == 1 ? "" : "s");
+    }
+    else
+    {
+        printf("Projected completion: unknown (no progress in the last %d days)\n", PACE_WINDOW_DAYS);
+    }
+}
+
+void display_chapter_list(int video_number)
+{
+    VideoInfo *vid = g_video_list[video_number - 1];
+    if (vid->chapters.count == 0)
+    {
+        printf("Video %d ('%s') has no chapters.\n", video_number, vid->path);
+        return;
+    }
+
+    printf("\n--- Chapters: %s ---\n", vid->path);
+    for (size_t i = 0; i < vid->chapters.count; i++)
+    {
+        const ChapterInfo *chapter = &vid->chapters.items[i];
+        long long length = chapter->end_sec - chapter->start_sec;
+
+        char status_str[15] = "";
+        if (vid->watched_sec >= chapter->end_sec)
+        {
+            snprintf(status_str, sizeof(status_str), "[✓]");
+        }
+        else if (vid->watched_sec > chapter->start_sec && length > 0)
+        {
+            int percentage = (int)(100 * (vid->watched_sec - chapter->start_sec) / length);
+            snprintf(status_str, sizeof(status_str), "[%d%%]", percentage);
+        }
+
+        char numbered_title[32];
+        const char *title = chapter->title;
+        if (!title[0])
+        {
+            snprintf(numbered_title, sizeof(numbered_title), "Chapter %zu", i + 1);
+            title = numbered_title;
+        }
+
+        // Titles are padded and cut by code points, never inside a character
+        size_t width = display_width(title);
+        int title_bytes = (int)strlen(title);
+        const char *ellipsis = "";
+        if (width > CHAPTER_TITLE_COLUMN)
+        {
+            title_bytes = (int)(first_columns(title, CHAPTER_TITLE_COLUMN - 3) - title);
+            ellipsis = "...";
+            width = CHAPTER_TITLE_COLUMN;
+        }
+
+        printf("%2zu. %.*s%s%*s [%02lld:%02lld:%02lld - %02lld:%02lld:%02lld] %s\n", i + 1,
+               title_bytes, title, ellipsis, (int)(CHAPTER_TITLE_COLUMN - width), "",
+               chapter->start_sec / 3600, (chapter->start_sec % 3600) / 60, chapter->start_sec % 60,
+               chapter->end_sec / 3600, (chapter->end_sec % 3600) / 60, chapter->end_sec % 60,
+               status_str);
+    }
+}
+
+void set_default_course_name()
+{
+    free(g_course_name);
+    g_course_name = NULL;
+
+    char cwd[1024];
+    if (getcwd(cwd, sizeof(cwd)) != NULL)
+    {
+        char *cwd_copy = strdup(cwd);
+        g_course_name = strdup(basename(cwd_copy));
+        free(cwd_copy);
+    }
+    else
+    {
+        g_course_name = strdup("Untitled Course");
     }
 }
 
@@ -70,25 +557,13 @@ void prompt_for_course_name()
     {
         input_buffer[strcspn(input_buffer, "\n")] = 0;
 
-        free(g_course_name);
-        g_course_name = NULL;
-
         if (strlen(input_buffer) == 0)
         {
-            char cwd[1024];
-            if (getcwd(cwd, sizeof(cwd)) != NULL)
-            {
-                char *cwd_copy = strdup(cwd);
-                g_course_name = strdup(basename(cwd_copy));
-                free(cwd_copy);
-            }
-            else
-            {
-                g_course_name = strdup("Untitled Course");
-            }
+            set_default_course_name();
         }
         else
         {
+            free(g_course_name);
             g_course_name = strdup(input_buffer);
         }
     }
@@ -98,13 +573,25 @@ void show_help()
 {
     printf("mirava - A simple video course progress tracker.\n\n");
     printf("Usage:\n");
-    printf("  mirava                     - List videos and sync progress.\n");
+    printf("  mirava [options]           - List videos and sync progress.\n");
+    printf("  mirava list [options]      - List videos from the saved data without syncing.\n");
     printf("  mirava set <num> <val>     - Set progress for video <num>.\n");
     printf("  mirava mark <num> [num...] - Mark video(s) as complete.\n");
+    printf("  mirava chapters <num>      - List the chapters of video <num>.\n");
+    printf("  mirava import-mpv [dir]    - Import resume positions from mpv's watch_later.\n");
+    printf("  mirava export [file]       - Export your progress as a snapshot.\n");
+    printf("  mirava import <file> [--policy max|lww]\n");
+    printf("                             - Merge a progress snapshot from another machine.\n");
+    printf("  mirava stats               - Show watch pace, streaks and completion ETA.\n");
     printf("  mirava help                - Show this help message.\n\n");
+    printf("List options:\n");
+    printf("  --format json|tsv          - Machine-readable output for scripts.\n");
+    printf("  --unwatched                - Only show videos that are not complete.\n");
+    printf("  --dir <dir>                - Only show videos under <dir> (relative to the current directory).\n\n");
     printf("Examples:\n");
     printf("  mirava set 3 50%%            - Set video 3 to 50%% watched.\n");
     printf("  mirava set 5 1:20:10         - Set video 5 to 1h 20m 10s watched.\n");
+    printf("  mirava set 4 ch:5            - Set video 4 as watched through chapter 5.\n");
     printf("  mirava mark 8              - Mark video 8 as 100%% watched.\n");
     printf("  mirava mark 3 5 7          - Mark videos 3, 5, and 7 as 100%% watched.\n");
 }
@@ -1,12 +1,39 @@
 #ifndef CLI_H
 #define CLI_H
 
+// Output formats of the video listing.
+typedef enum {
+    FORMAT_HUMAN,
+    FORMAT_JSON,
+    FORMAT_TSV
+} OutputFormat;
+
+// How the video listing is rendered and which videos it includes.
+typedef struct {
+    OutputFormat format;
+    int unfinished_only;    // --unwatched: hide videos that are complete
+    const char *dir;        // --dir: only videos under this directory
+} ListOptions;
+
+// Parses listing options (--format json|tsv, --unwatched, --dir X) from
+// argv[first..argc-1]. Returns 0 and reports the problem on invalid input.
+int parse_list_options(int argc, char *argv[], int first, ListOptions *options);
+
 // Displays the list of videos with their status and a final summary.
-void display_video_list();
+void display_video_list(const ListOptions *options);
+
+// Displays the chapters of a video (1-based number) with their status.
+void display_chapter_list(int video_number);
+
+// Displays watch pace, streaks and the projected completion date.
+void display_watch_stats();
 
 // Prompts the user to enter a name for the course.
 void prompt_for_course_name();
 
+// Names the course after the current directory.
+void set_default_course_name();
+
 // Shows the help message.
 void show_help();
 
@@ -0,0 +1,600 @@
+#define _DEFAULT_SOURCE
+#define _FILE_OFFSET_BITS 64
+#include "container_parser.h"
+#include "video_list.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/types.h>
+
+// --- Byte helpers ---
+
+static uint32_t be32(const unsigned char *p)
+{
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static uint64_t be64(const unsigned char *p)
+{
+    return ((uint64_t)be32(p) << 32) | be32(p + 4);
+}
+
+static uint32_t le32(const unsigned char *p)
+{
+    return ((uint32_t)p[3] << 24) | ((uint32_t)p[2] << 16) | ((uint32_t)p[1] << 8) | p[0];
+}
+
+static uint64_t le64(const unsigned char *p)
+{
+    return ((uint64_t)le32(p + 4) << 32) | le32(p);
+}
+
+static double be_double(const unsigned char *p)
+{
+    uint64_t bits = be64(p);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static int read_at(FILE *f, off_t offset, void *buffer, size_t size)
+{
+    return fseeko(f, offset, SEEK_SET) == 0 && fread(buffer, 1, size, f) == size;
+}
+
+// Containers may omit chapter end times; each chapter then ends where the
+// next one starts, and the last one at the end of the video.
+static void fill_chapter_ends(ChapterTable *chapters, long long duration)
+{
+    for (size_t i = 0; chapters && i < chapters->count; i++)
+    {
+        ChapterInfo *chapter = &chapters->items[i];
+        if (chapter->end_sec <= chapter->start_sec)
+        {
+            chapter->end_sec = (i + 1 < chapters->count) ? chapters->items[i + 1].start_sec : duration;
+        }
+    }
+}
+
+// --- MP4 / QuickTime ---
+
+// Finds the box `type` among the boxes in [start, end) and returns its payload range.
+static int mp4_find_box(FILE *f, off_t start, off_t end, const char *type, off_t *payload, off_t *payload_end)
+{
+    unsigned char header[16];
+    off_t pos = start;
+
+    while (pos + 8 <= end)
+    {
+        if (!read_at(f, pos, header, 8))
+            return 0;
+
+        uint64_t size = be32(header);
+        off_t header_size = 8;
+        if (size == 1)
+        {
+            if (fread(header + 8, 1, 8, f) != 8)
+                return 0;
+            size = be64(header + 8);
+            header_size = 16;
+        }
+        else if (size == 0)
+        {
+            size = (uint64_t)(end - pos); // Box extends to the end of its parent
+        }
+        if (size < (uint64_t)header_size || size > (uint64_t)(end - pos))
+            return 0;
+
+        if (memcmp(header + 4, type, 4) == 0)
+        {
+            *payload = pos + header_size;
+            *payload_end = pos + (off_t)size;
+            return 1;
+        }
+        pos += (off_t)size;
+    }
+    return 0;
+}
+
+// Reads Nero-style chapters from moov/udta/chpl. Start times are in 100ns units.
+static void parse_mp4_chapters(FILE *f, off_t moov, off_t moov_end, ChapterTable *chapters)
+{
+    off_t udta, udta_end, chpl, chpl_end;
+    if (!mp4_find_box(f, moov, moov_end, "udta", &udta, &udta_end) ||
+        !mp4_find_box(f, udta, udta_end, "chpl", &chpl, &chpl_end))
+        return;
+
+    unsigned char header[9];
+    if (chpl_end - chpl < 5 || !read_at(f, chpl, header, 9))
+        return;
+
+    // version(1) flags(3), plus reserved(4) in version 1, then count(1)
+    off_t pos = chpl + (header[0] ? 9 : 5);
+    int count = header[0] ? header[8] : header[4];
+
+    for (int i = 0; i < count && pos + 9 <= chpl_end; i++)
+    {
+        unsigned char entry[9];
+        char title[256];
+        if (!read_at(f, pos, entry, 9))
+            return;
+
+        size_t title_length = entry[8];
+        if (pos + 9 + (off_t)title_length > chpl_end || fread(title, 1, title_length, f) != title_length)
+            return;
+        title[title_length] = '\0';
+
+        add_chapter_to_table(chapters, title, (long long)(be64(entry) / 10000000), 0);
+        pos += 9 + (off_t)title_length;
+    }
+}
+
+static long long parse_mp4(FILE *f, off_t file_size, ChapterTable *chapters)
+{
+    off_t moov, moov_end, mvhd, mvhd_end;
+    if (!mp4_find_box(f, 0, file_size, "moov", &moov, &moov_end) ||
+        !mp4_find_box(f, moov, moov_end, "mvhd", &mvhd, &mvhd_end))
+        return -1;
+
+    unsigned char box[32];
+    if (!read_at(f, mvhd, box, 1))
+        return -1;
+
+    uint32_t timescale;
+    uint64_t duration;
+    if (box[0] == 1)
+    {
+        // version(1) flags(3) creation(8) modification(8) timescale(4) duration(8)
+        if (mvhd_end - mvhd < 32 || !read_at(f, mvhd, box, 32))
+            return -1;
+        timescale = be32(box + 20);
+        duration = be64(box + 24);
+    }
+    else
+    {
+        // version(1) flags(3) creation(4) modification(4) timescale(4) duration(4)
+        if (mvhd_end - mvhd < 20 || !read_at(f, mvhd, box, 20))
+            return -1;
+        timescale = be32(box + 12);
+        duration = be32(box + 16);
+        if (duration == UINT32_MAX)
+            duration = UINT64_MAX;
+    }
+
+    long long seconds = (timescale == 0 || duration == UINT64_MAX) ? 0 : (long long)(duration / timescale);
+    if (chapters)
+    {
+        parse_mp4_chapters(f, moov, moov_end, chapters);
+        fill_chapter_ends(chapters, seconds);
+    }
+    return seconds;
+}
+
+// --- Matroska / WebM ---
+
+#define EBML_UNKNOWN_SIZE UINT64_MAX
+
+#define MKV_ID_SEGMENT 0x18538067
+#define MKV_ID_INFO 0x1549A966
+#define MKV_ID_TIMECODE_SCALE 0x2AD7B1
+#define MKV_ID_DURATION 0x4489
+#define MKV_ID_CLUSTER 0x1F43B675
+#define MKV_ID_CHAPTERS 0x1043A770
+#define MKV_ID_EDITION_ENTRY 0x45B9
+#define MKV_ID_CHAPTER_ATOM 0xB6
+#define MKV_ID_CHAPTER_TIME_START 0x91
+#define MKV_ID_CHAPTER_TIME_END 0x92
+#define MKV_ID_CHAPTER_DISPLAY 0x80
+#define MKV_ID_CHAP_STRING 0x85
+
+// Reads an element ID (1-4 bytes, length marker kept as part of the ID).
+static int ebml_read_id(FILE *f, uint32_t *id)
+{
+    int c = fgetc(f);
+    if (c == EOF || c == 0)
+        return 0;
+
+    int length = 1;
+    for (int mask = 0x80; !(c & mask); mask >>= 1)
+        length++;
+    if (length > 4)
+        return 0;
+
+    uint32_t value = (uint32_t)c;
+    for (int i = 1; i < length; i++)
+    {
+        if ((c = fgetc(f)) == EOF)
+            return 0;
+        value = (value << 8) | (uint32_t)c;
+    }
+    *id = value;
+    return length;
+}
+
+// Reads an element data size (1-8 bytes, length marker stripped).
+static int ebml_read_size(FILE *f, uint64_t *size)
+{
+    int c = fgetc(f);
+    if (c == EOF || c == 0)
+        return 0;
+
+    int length = 1;
+    int mask = 0x80;
+    while (!(c & mask))
+    {
+        mask >>= 1;
+        length++;
+    }
+
+    uint64_t value = (uint64_t)(c & (mask - 1));
+    int all_ones = (value == (uint64_t)(mask - 1));
+    for (int i = 1; i < length; i++)
+    {
+        if ((c = fgetc(f)) == EOF)
+            return 0;
+        value = (value << 8) | (uint64_t)c;
+        all_ones = all_ones && c == 0xFF;
+    }
+    *size = all_ones ? EBML_UNKNOWN_SIZE : value;
+    return length;
+}
+
+static uint64_t ebml_read_uint(FILE *f, uint64_t size)
+{
+    uint64_t value = 0;
+    for (uint64_t i = 0; i < size && i < 8; i++)
+    {
+        int c = fgetc(f);
+        if (c == EOF)
+            return 0;
+        value = (value << 8) | (uint64_t)c;
+    }
+    return value;
+}
+
+static double ebml_read_float(FILE *f, uint64_t size)
+{
+    unsigned char bytes[8];
+    if ((size != 4 && size != 8) || fread(bytes, 1, (size_t)size, f) != size)
+        return 0.0;
+
+    if (size == 4)
+    {
+        uint32_t bits = be32(bytes);
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    return be_double(bytes);
+}
+
+// Reads the next element header at pos. Fails on unknown sizes and elements
+// that would extend past end.
+static int ebml_next(FILE *f, off_t pos, off_t end, uint32_t *id, off_t *data, off_t *data_end)
+{
+    uint64_t size;
+    if (fseeko(f, pos, SEEK_SET) != 0 || !ebml_read_id(f, id) || !ebml_read_size(f, &size) ||
+        size == EBML_UNKNOWN_SIZE)
+        return 0;
+
+    *data = ftello(f);
+    if (*data < 0 || size > (uint64_t)(end - *data))
+        return 0;
+    *data_end = *data + (off_t)size;
+    return 1;
+}
+
+static long long parse_matroska_info(FILE *f, off_t pos, off_t end)
+{
+    uint64_t timecode_scale = 1000000; // Default: milliseconds
+    double duration = -1.0;
+    uint32_t id;
+    off_t data, data_end;
+
+    for (; pos < end && ebml_next(f, pos, end, &id, &data, &data_end); pos = data_end)
+    {
+        if (id == MKV_ID_TIMECODE_SCALE)
+            timecode_scale = ebml_read_uint(f, (uint64_t)(data_end - data));
+        else if (id == MKV_ID_DURATION)
+            duration = ebml_read_float(f, (uint64_t)(data_end - data));
+    }
+
+    if (duration < 0.0)
+        return 0;
+    return (long long)(duration * (double)timecode_scale / 1e9);
+}
+
+static void parse_matroska_chapter_atom(FILE *f, off_t pos, off_t end, ChapterTable *chapters)
+{
+    uint64_t start_ns = 0, end_ns = 0;
+    char title[256] = "";
+    uint32_t id;
+    off_t data, data_end;
+
+    for (; pos < end && ebml_next(f, pos, end, &id, &data, &data_end); pos = data_end)
+    {
+        if (id == MKV_ID_CHAPTER_TIME_START)
+        {
+            start_ns = ebml_read_uint(f, (uint64_t)(data_end - data));
+        }
+        else if (id == MKV_ID_CHAPTER_TIME_END)
+        {
+            end_ns = ebml_read_uint(f, (uint64_t)(data_end - data));
+        }
+        else if (id == MKV_ID_CHAPTER_DISPLAY && title[0] == '\0')
+        {
+            // Use the first ChapString of the first display entry
+            off_t display = data, string, string_end;
+            for (; display < data_end && ebml_next(f, display, data_end, &id, &string, &string_end); display = string_end)
+            {
+                if (id == MKV_ID_CHAP_STRING)
+                {
+                    size_t length = (size_t)(string_end - string);
+                    if (length >= sizeof(title))
+                        length = sizeof(title) - 1;
+                    if (fread(title, 1, length, f) != length)
+                        length = 0;
+                    title[length] = '\0';
+                    break;
+                }
+            }
+        }
+    }
+
+    // Chapter times are always in nanoseconds, independent of TimecodeScale
+    add_chapter_to_table(chapters, title, (long long)(start_ns / 1000000000), (long long)(end_ns / 1000000000));
+}
+
+// Reads the top-level chapter atoms of the first edition.
+static void parse_matroska_chapters(FILE *f, off_t pos, off_t end, ChapterTable *chapters)
+{
+    uint32_t id;
+    off_t data, data_end;
+
+    for (; pos < end && ebml_next(f, pos, end, &id, &data, &data_end); pos = data_end)
+    {
+        if (id != MKV_ID_EDITION_ENTRY)
+            continue;
+
+        off_t atom = data, atom_data, atom_end;
+        for (; atom < data_end && ebml_next(f, atom, data_end, &id, &atom_data, &atom_end); atom = atom_end)
+        {
+            if (id == MKV_ID_CHAPTER_ATOM)
+                parse_matroska_chapter_atom(f, atom_data, atom_end, chapters);
+        }
+        return;
+    }
+}
+
+static long long parse_matroska(FILE *f, off_t file_size, ChapterTable *chapters)
+{
+    off_t pos = 0;
+
+    // Top level: skip the EBML header and find the Segment
+    while (pos < file_size)
+    {
+        uint32_t id;
+        uint64_t size;
+        if (fseeko(f, pos, SEEK_SET) != 0 || !ebml_read_id(f, &id) || !ebml_read_size(f, &size))
+            return -1;
+
+        off_t data = ftello(f);
+        if (id == MKV_ID_SEGMENT)
+        {
+            off_t segment_end = (size == EBML_UNKNOWN_SIZE || data + (off_t)size > file_size)
+                                    ? file_size : data + (off_t)size;
+            long long duration = 0;
+            off_t child, child_end;
+
+            // Info and Chapters precede the media data in practice; stop at the first
+            // cluster (or any element of unknown size) rather than walking the whole file
+            for (pos = data; pos < segment_end && ebml_next(f, pos, segment_end, &id, &child, &child_end); pos = child_end)
+            {
+                if (id == MKV_ID_CLUSTER)
+                    break;
+                if (id == MKV_ID_INFO)
+                    duration = parse_matroska_info(f, child, child_end);
+                else if (id == MKV_ID_CHAPTERS && chapters && chapters->count == 0)
+                    parse_matroska_chapters(f, child, child_end, chapters);
+            }
+
+            fill_chapter_ends(chapters, duration);
+            return duration;
+        }
+        if (size == EBML_UNKNOWN_SIZE)
+            return -1;
+        pos = data + (off_t)size;
+    }
+    return -1;
+}
+
+// --- AVI ---
+
+static long long parse_avi(FILE *f, off_t file_size)
+{
+    unsigned char chunk[12];
+    off_t pos = 12; // After "RIFF" <size> "AVI "
+
+    while (pos + 8 <= file_size)
+    {
+        if (!read_at(f, pos, chunk, 12))
+            return -1;
+
+        uint32_t size = le32(chunk + 4);
+        if (memcmp(chunk, "LIST", 4) == 0 && memcmp(chunk + 8, "hdrl", 4) == 0)
+        {
+            // The main AVI header is the first chunk of the hdrl list
+            unsigned char avih[28];
+            if (!read_at(f, pos + 12, avih, sizeof(avih)) || memcmp(avih, "avih", 4) != 0)
+                return -1;
+
+            uint64_t usec_per_frame = le32(avih + 8);
+            uint64_t total_frames = le32(avih + 8 + 16);
+            return (long long)(usec_per_frame * total_frames / 1000000);
+        }
+        pos += 8 + (off_t)size + (size & 1);
+    }
+    return -1;
+}
+
+// --- ASF / WMV ---
+
+static const unsigned char asf_header_guid[16] = {
+    0x30, 0x26, 0xB2, 0x75, 0x8E, 0x66, 0xCF, 0x11, 0xA6, 0xD9, 0x00, 0xAA, 0x00, 0x62, 0xCE, 0x6C
+};
+static const unsigned char asf_file_properties_guid[16] = {
+    0xA1, 0xDC, 0xAB, 0x8C, 0x47, 0xA9, 0xCF, 0x11, 0x8E, 0xE4, 0x00, 0xC0, 0x0C, 0x20, 0x53, 0x65
+};
+
+static long long parse_asf(FILE *f, off_t file_size)
+{
+    unsigned char object[24];
+    if (!read_at(f, 0, object, 24))
+        return -1;
+
+    off_t header_end = (off_t)le64(object + 16);
+    if (header_end > file_size)
+        header_end = file_size;
+
+    off_t pos = 30; // Header object: GUID(16) size(8) count(4) reserved(2)
+    while (pos + 24 <= header_end)
+    {
+        if (!read_at(f, pos, object, 24))
+            return -1;
+
+        uint64_t size = le64(object + 16);
+        if (size < 24)
+            return -1;
+
+        if (memcmp(object, asf_file_properties_guid, 16) == 0)
+        {
+            // file id(16) file size(8) creation(8) packets(8) play duration(8) send duration(8) preroll(8)
+            unsigned char props[64];
+            if (!read_at(f, pos + 24, props, sizeof(props)))
+                return -1;
+
+            uint64_t play_duration = le64(props + 40); // 100-nanosecond units
+            uint64_t preroll_ms = le64(props + 56);
+            long long seconds = (long long)(play_duration / 10000000) - (long long)(preroll_ms / 1000);
+            return seconds > 0 ? seconds : 0;
+        }
+        pos += (off_t)size;
+    }
+    return -1;
+}
+
+// --- FLV ---
+
+// Skips one AMF0 value of a simple type. Returns 0 for types we do not walk.
+static int amf_skip_value(FILE *f, int type)
+{
+    unsigned char buffer[2];
+    switch (type)
+    {
+    case 0: // Number
+        return fseeko(f, 8, SEEK_CUR) == 0;
+    case 1: // Boolean
+        return fseeko(f, 1, SEEK_CUR) == 0;
+    case 2: // String
+        if (fread(buffer, 1, 2, f) != 2)
+            return 0;
+        return fseeko(f, (buffer[0] << 8) | buffer[1], SEEK_CUR) == 0;
+    case 11: // Date
+        return fseeko(f, 10, SEEK_CUR) == 0;
+    default:
+        return 0;
+    }
+}
+
+static long long parse_flv(FILE *f)
+{
+    unsigned char tag[16];
+
+    // Header(9) + PreviousTagSize0(4), then the first tag should be onMetaData
+    if (!read_at(f, 13, tag, 11) || tag[0] != 18)
+        return -1;
+
+    unsigned char name[13];
+    if (fread(name, 1, 13, f) != 13 || name[0] != 2 || memcmp(name + 3, "onMetaData", 10) != 0)
+        return -1;
+
+    int type = fgetc(f);
+    if (type == 8) // ECMA array: count(4) precedes the properties
+    {
+        if (fseeko(f, 4, SEEK_CUR) != 0)
+            return -1;
+    }
+    else if (type != 3) // Object
+    {
+        return -1;
+    }
+
+    for (;;)
+    {
+        unsigned char key_length[2];
+        char key[64];
+        if (fread(key_length, 1, 2, f) != 2)
+            return -1;
+
+        size_t length = ((size_t)key_length[0] << 8) | key_length[1];
+        if (length == 0) // Object end marker
+            return 0;
+        if (length >= sizeof(key))
+        {
+            if (fseeko(f, (off_t)length, SEEK_CUR) != 0)
+                return -1;
+            key[0] = '\0';
+        }
+        else
+        {
+            if (fread(key, 1, length, f) != length)
+                return -1;
+            key[length] = '\0';
+        }
+
+        type = fgetc(f);
+        if (type == 0 && strcmp(key, "duration") == 0)
+        {
+            unsigned char number[8];
+            if (fread(number, 1, 8, f) != 8)
+                return -1;
+            double duration = be_double(number);
+            return duration > 0.0 ? (long long)duration : 0;
+        }
+        if (type == EOF || !amf_skip_value(f, type))
+            return 0;
+    }
+}
+
+long long parse_container_duration(const char *filepath, ChapterTable *chapters)
+{
+    FILE *f = fopen(filepath, "rb");
+    if (!f)
+        return -1;
+
+    unsigned char magic[16];
+    long long duration = -1;
+    off_t file_size = 0;
+
+    if (fseeko(f, 0, SEEK_END) == 0)
+        file_size = ftello(f);
+
+    if (file_size >= 16 && read_at(f, 0, magic, sizeof(magic)))
+    {
+        if (memcmp(magic, "\x1A\x45\xDF\xA3", 4) == 0)
+            duration = parse_matroska(f, file_size, chapters);
+        else if (memcmp(magic, "RIFF", 4) == 0 && memcmp(magic + 8, "AVI ", 4) == 0)
+            duration = parse_avi(f, file_size);
+        else if (memcmp(magic, asf_header_guid, 16) == 0)
+            duration = parse_asf(f, file_size);
+        else if (memcmp(magic, "FLV", 3) == 0)
+            duration = parse_flv(f);
+        else if (memcmp(magic + 4, "ftyp", 4) == 0 || memcmp(magic + 4, "moov", 4) == 0 ||
+                 memcmp(magic + 4, "mdat", 4) == 0 || memcmp(magic + 4, "free", 4) == 0 ||
+                 memcmp(magic + 4, "wide", 4) == 0 || memcmp(magic + 4, "skip", 4) == 0)
+            duration = parse_mp4(f, file_size, chapters);
+    }
+
+    fclose(f);
+    return duration;
+}
@@ -0,0 +1,12 @@
+#ifndef CONTAINER_PARSER_H
+#define CONTAINER_PARSER_H
+
+#include "types.h"
+
+// Reads the duration of a video file in seconds straight from its container
+// headers (MP4/MOV, Matroska/WebM, AVI, ASF/WMV and FLV), without FFmpeg.
+// Matroska chapters and MP4 Nero chapters are stored in chapters if not NULL.
+// Returns -1 if the file could not be opened or the container is unsupported.
+long long parse_container_duration(const char *filepath, ChapterTable *chapters);
+
+#endif // CONTAINER_PARSER_H
@@ -1,6 +1,7 @@
 #define _DEFAULT_SOURCE
 #include "data_manager.h"
 #include "video_list.h"
+#include "history.h"
 #include "globals.h" // Use the centralized global declarations
 #include <jansson.h>
 #include <stdio.h>
@@ -10,12 +11,22 @@
 #include <sys/stat.h>
 #include <limits.h>
 #include <libgen.h>
+#include <ctype.h>
+#include <errno.h>
 
 #define DATA_FILE ".mirava_data.json"
+#define PROGRESS_DIR ".mirava_progress"
 
 // Global variable to store the course root directory
 static char *g_course_root_dir = NULL;
 
+// Next catalog entry id to hand out
+static unsigned long g_next_entry_id = 1;
+
+// Set when the loaded progress came from a pre-overlay data file and still
+// has to be moved out of the catalog by the next save
+static int g_legacy_progress_pending = 0;
+
 // Function to find the course root directory by searching for .mirava_data.json
 // Returns the path to the directory containing the JSON file, or NULL if not found
 static char* find_course_root()
@@ -66,11 +77,229 @@ static char* find_course_root()
     return NULL;
 }
 
+// Gets a file-name-safe name for the current user's progress overlay
+static void get_user_name(char *buffer, size_t size)
+{
+    const char *name = getenv("MIRAVA_USER");
+    if (!name || !name[0])
+        name = getenv("USER");
+    if (!name || !name[0])
+        name = getenv("USERNAME");
+    if (!name || !name[0])
+        name = "default";
+
+    snprintf(buffer, size, "%s", name);
+    for (char *c = buffer; *c; c++)
+    {
+        if (!isalnum((unsigned char)*c) && *c != '-' && *c != '_' && (*c != '.' || c == buffer))
+        {
+            *c = '_';
+        }
+    }
+}
+
+static void build_user_file_path(char *buffer, size_t size, const char *suffix)
+{
+    char user[128];
+    get_user_name(user, sizeof(user));
+    snprintf(buffer, size, "%s/%s/%s%s", g_course_root_dir ? g_course_root_dir : ".", PROGRESS_DIR, user, suffix);
+}
+
+int prepare_user_file_path(char *buffer, size_t size, const char *suffix)
+{
+    char dir_path[PATH_MAX];
+    snprintf(dir_path, sizeof(dir_path), "%s/%s", g_course_root_dir ? g_course_root_dir : ".", PROGRESS_DIR);
+#ifdef _WIN32
+    int created = mkdir(dir_path);
+#else
+    // Every learner of a shared course writes their own files here, so the
+    // directory is world-writable and sticky like /tmp: anyone can add files,
+    // but only their owner can replace or delete them. chmod() is needed
+    // because mkdir() applies the umask.
+    int created = mkdir(dir_path, 01777);
+    if (created == 0 && chmod(dir_path, 01777) != 0)
+    {
+        fprintf(stderr, "Warning: Could not make '%s' writable for other users.\n", dir_path);
+    }
+#endif
+    build_user_file_path(buffer, size, suffix);
+    return created == 0 || errno == EEXIST;
+}
+
+// Reads the rolling watch-history aggregates from the "stats" object
+static void load_watch_stats(json_t *stats_obj)
+{
+    reset_watch_stats();
+    if (!json_is_object(stats_obj))
+        return;
+
+    WatchStats *stats = get_watch_stats();
+    stats->first_day = json_integer_value(json_object_get(stats_obj, "first_day"));
+    stats->last_day = json_integer_value(json_object_get(stats_obj, "last_day"));
+    stats->total_sec = json_integer_value(json_object_get(stats_obj, "total_sec"));
+    stats->current_streak = (int)json_integer_value(json_object_get(stats_obj, "current_streak"));
+    stats->longest_streak = (int)json_integer_value(json_object_get(stats_obj, "longest_streak"));
+
+    json_t *daily_array = json_object_get(stats_obj, "daily_sec");
+    for (size_t i = 0; i < PACE_WINDOW_DAYS && i < json_array_size(daily_array); i++)
+    {
+        stats->daily_sec[i] = json_integer_value(json_array_get(daily_array, i));
+    }
+}
+
+static json_t* watch_stats_to_json(const WatchStats *stats)
+{
+    json_t *daily_array = json_array();
+    for (size_t i = 0; i < PACE_WINDOW_DAYS; i++)
+    {
+        json_array_append_new(daily_array, json_integer(stats->daily_sec[i]));
+    }
+
+    return json_pack("{s:I, s:I, s:o, s:I, s:i, s:i}",
+                     "first_day", (json_int_t)stats->first_day,
+                     "last_day", (json_int_t)stats->last_day,
+                     "daily_sec", daily_array,
+                     "total_sec", (json_int_t)stats->total_sec,
+                     "current_streak", stats->current_streak,
+                     "longest_streak", stats->longest_streak);
+}
+
+// Reads a cached chapter table: [{"title": ..., "start": ..., "end": ...}, ...]
+static void load_chapters(json_t *chapters_array, ChapterTable *chapters)
+{
+    size_t index;
+    json_t *value;
+    json_array_foreach(chapters_array, index, value)
+    {
+        add_chapter_to_table(chapters,
+                             json_string_value(json_object_get(value, "title")),
+                             json_integer_value(json_object_get(value, "start")),
+                             json_integer_value(json_object_get(value, "end")));
+    }
+}
+
+static json_t* chapters_to_json(const ChapterTable *chapters)
+{
+    json_t *chapters_array = json_array();
+    for (size_t i = 0; i < chapters->count; i++)
+    {
+        const ChapterInfo *chapter = &chapters->items[i];
+        // Every chapter is kept, even without a title, so chapter numbers
+        // stay the same after a reload
+        json_t *chapter_obj = json_pack("{s:s, s:I, s:I}",
+                                        "title", chapter->title ? chapter->title : "",
+                                        "start", (json_int_t)chapter->start_sec,
+                                        "end", (json_int_t)chapter->end_sec);
+        if (!chapter_obj)
+        {
+            chapter_obj = json_pack("{s:s, s:I, s:I}",
+                                    "title", "",
+                                    "start", (json_int_t)chapter->start_sec,
+                                    "end", (json_int_t)chapter->end_sec);
+        }
+        json_array_append_new(chapters_array, chapter_obj);
+    }
+    return chapters_array;
+}
+
+// Maps catalog entry ids to videos for the lookups of an overlay load.
+// Ids are handed out sequentially, so a direct table stays compact.
+static VideoInfo** build_id_table()
+{
+    VideoInfo **by_id = calloc(g_next_entry_id, sizeof(VideoInfo *));
+    if (!by_id)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for entry id table.\n");
+        return NULL;
+    }
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        if (g_video_list[i]->id < g_next_entry_id)
+        {
+            by_id[g_video_list[i]->id] = g_video_list[i];
+        }
+    }
+    return by_id;
+}
+
+// Returns 1 if a catalog still holds progress from before per-user overlays
+static int has_legacy_progress(json_t *catalog_root)
+{
+    if (json_object_get(catalog_root, "stats"))
+        return 1;
+
+    size_t index;
+    json_t *value;
+    json_array_foreach(json_object_get(catalog_root, "videos"), index, value)
+    {
+        if (json_object_get(value, "watched_sec"))
+            return 1;
+    }
+    return 0;
+}
+
+// Applies the current user's progress overlay on top of the loaded catalog
+static void load_progress_overlay(json_t *catalog_root)
+{
+    char overlay_path[PATH_MAX];
+    json_error_t error;
+    build_user_file_path(overlay_path, sizeof(overlay_path), ".json");
+
+    json_t *overlay = json_load_file(overlay_path, 0, &error);
+    if (!overlay)
+    {
+        // No overlay yet: the progress and stats of a pre-overlay data file
+        // become this user's. Loading never writes; the next save moves them.
+        load_watch_stats(json_object_get(catalog_root, "stats"));
+        g_legacy_progress_pending = has_legacy_progress(catalog_root);
+        return;
+    }
+
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        g_video_list[i]->watched_sec = 0;
+    }
+
+    VideoInfo **by_id = build_id_table();
+    if (by_id)
+    {
+        const char *key;
+        json_t *value;
+        json_object_foreach(json_object_get(overlay, "watched"), key, value)
+        {
+            unsigned long id = strtoul(key, NULL, 10);
+            if (id < g_next_entry_id && by_id[id])
+            {
+                // [watched_sec, updated_at], or a bare watched_sec in older overlays
+                if (json_is_array(value))
+                {
+                    by_id[id]->watched_sec = json_integer_value(json_array_get(value, 0));
+                    by_id[id]->updated_at = json_integer_value(json_array_get(value, 1));
+                }
+                else
+                {
+                    by_id[id]->watched_sec = json_integer_value(value);
+                }
+            }
+        }
+        free(by_id);
+    }
+
+    load_watch_stats(json_object_get(overlay, "stats"));
+    json_decref(overlay);
+}
+
 void load_data_from_json()
 {
     json_t *root;
     json_error_t error;
     char json_path[PATH_MAX];
+
+    // Start from a clean slate so repeated loads do not duplicate entries
+    cleanup_video_list();
+    reset_watch_stats();
+    g_next_entry_id = 1;
+    g_legacy_progress_pending = 0;
     
     // First, try to find course root directory
     free(g_course_root_dir);
@@ -112,6 +341,12 @@ void load_data_from_json()
         g_course_name = strdup(json_string_value(name_obj));
     }
 
+    json_int_t next_id = json_integer_value(json_object_get(root, "next_id"));
+    if (next_id > 0)
+    {
+        g_next_entry_id = (unsigned long)next_id;
+    }
+
     json_t *videos_array = json_object_get(root, "videos");
     if (json_is_array(videos_array))
     {
@@ -120,41 +355,97 @@ void load_data_from_json()
         json_array_foreach(videos_array, index, value)
         {
             const char *path = json_string_value(json_object_get(value, "path"));
-            json_int_t duration = json_integer_value(json_object_get(value, "duration_sec"));
-            json_int_t watched = json_integer_value(json_object_get(value, "watched_sec"));
+            const char *fingerprint = json_string_value(json_object_get(value, "fingerprint"));
 
             if (path)
             {
-                VideoInfo *vid = malloc(sizeof(VideoInfo));
+                VideoInfo *vid = create_video_info(path);
                 if (vid)
                 {
-                    vid->path = strdup(path);
-                    vid->duration_sec = duration;
-                    vid->watched_sec = watched;
-                    vid->found_on_disk = 0;
+                    vid->id = (unsigned long)json_integer_value(json_object_get(value, "id"));
+                    vid->duration_sec = json_integer_value(json_object_get(value, "duration_sec"));
+                    // Only present in data files written before progress overlays
+                    vid->watched_sec = json_integer_value(json_object_get(value, "watched_sec"));
+                    vid->file_size = json_integer_value(json_object_get(value, "size"));
+                    vid->mtime = json_integer_value(json_object_get(value, "mtime"));
+                    if (fingerprint)
+                    {
+                        snprintf(vid->fingerprint, sizeof(vid->fingerprint), "%s", fingerprint);
+                    }
+                    if (vid->id >= g_next_entry_id)
+                    {
+                        g_next_entry_id = vid->id + 1;
+                    }
+                    load_chapters(json_object_get(value, "chapters"), &vid->chapters);
                     add_video_to_list(vid);
                 }
             }
         }
     }
+
+    // Entries from data files written before ids existed get one now
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        if (g_video_list[i]->id == 0)
+        {
+            g_video_list[i]->id = allocate_entry_id();
+        }
+    }
+
+    load_progress_overlay(root);
     json_decref(root);
 }
 
-void save_data_to_json()
+// Writes to a temporary file and renames it over the target, so readers on a
+// shared course directory never see a half-written file.
+static int dump_json_atomically(json_t *root, const char *path, size_t flags)
+{
+    char tmp_path[PATH_MAX];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp%ld", path, (long)getpid());
+
+    if (json_dump_file(root, tmp_path, flags) != 0)
+    {
+        remove(tmp_path);
+        return 0;
+    }
+#ifdef _WIN32
+    remove(path); // rename() does not replace existing files on Windows
+#endif
+    if (rename(tmp_path, path) != 0)
+    {
+        remove(tmp_path);
+        return 0;
+    }
+    return 1;
+}
+
+// Writes the shared catalog. Returns 0 on failure.
+static int save_catalog_to_json()
 {
     json_t *root = json_object();
     json_object_set_new(root, "course_name", json_string(g_course_name ? g_course_name : ""));
+    json_object_set_new(root, "next_id", json_integer((json_int_t)g_next_entry_id));
 
     json_t *videos_array = json_array();
     for (size_t i = 0; i < g_video_count; i++)
     {
         VideoInfo *vid = g_video_list[i];
-        json_t *video_obj = json_pack("{s:s, s:I, s:I}",
+        json_t *video_obj = json_pack("{s:I, s:s, s:I, s:I, s:I}",
+                                      "id", (json_int_t)vid->id,
                                       "path", vid->path,
                                       "duration_sec", (json_int_t)vid->duration_sec,
-                                      "watched_sec", (json_int_t)vid->watched_sec);
+                                      "size", (json_int_t)vid->file_size,
+                                      "mtime", (json_int_t)vid->mtime);
         if (video_obj)
         {
+            if (vid->fingerprint[0])
+            {
+                json_object_set_new(video_obj, "fingerprint", json_string(vid->fingerprint));
+            }
+            if (vid->chapters.count > 0)
+            {
+                json_object_set_new(video_obj, "chapters", chapters_to_json(&vid->chapters));
+            }
             json_array_append_new(videos_array, video_obj);
         }
     }
@@ -167,11 +458,99 @@ void save_data_to_json()
         snprintf(json_path, sizeof(json_path), "%s", DATA_FILE);
     }
 
-    if (json_dump_file(root, json_path, JSON_INDENT(2)) != 0)
+    int written = dump_json_atomically(root, json_path, JSON_INDENT(2));
+    if (!written)
     {
         fprintf(stderr, "Error: Failed to write to JSON file '%s'.\n", json_path);
     }
     json_decref(root);
+    return written;
+}
+
+// Writes the current user's progress overlay. Returns 0 on failure.
+static int write_progress_overlay()
+{
+    json_t *root = json_object();
+    json_t *watched_obj = json_object();
+    char key[32];
+
+    // Only videos that were ever touched are stored, keeping the overlay small
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        VideoInfo *vid = g_video_list[i];
+        if (vid->watched_sec != 0 || vid->updated_at != 0)
+        {
+            snprintf(key, sizeof(key), "%lu", vid->id);
+            json_object_set_new(watched_obj, key, json_pack("[I, I]",
+                                                           (json_int_t)vid->watched_sec,
+                                                           (json_int_t)vid->updated_at));
+        }
+    }
+    json_object_set_new(root, "watched", watched_obj);
+
+    const WatchStats *stats = get_watch_stats();
+    if (stats->first_day != 0)
+    {
+        json_object_set_new(root, "stats", watch_stats_to_json(stats));
+    }
+
+    char overlay_path[PATH_MAX];
+    int written = prepare_user_file_path(overlay_path, sizeof(overlay_path), ".json") &&
+                  dump_json_atomically(root, overlay_path, JSON_COMPACT);
+    if (!written)
+    {
+        fprintf(stderr, "Error: Failed to write progress file '%s'.\n", overlay_path);
+    }
+    json_decref(root);
+    return written;
+}
+
+// Moves the progress of a pre-overlay data file into the current user's
+// overlay. The overlay is written first so the progress is never lost, and
+// removed again if the catalog cannot be rewritten without it, so that the
+// next user does not inherit the same progress.
+static int migrate_legacy_progress()
+{
+    char overlay_path[PATH_MAX];
+    build_user_file_path(overlay_path, sizeof(overlay_path), ".json");
+
+    if (!write_progress_overlay())
+        return 0;
+
+    if (!save_catalog_to_json())
+    {
+        remove(overlay_path);
+        fprintf(stderr, "Error: The progress stored in %s could not be moved to '%s', so nothing was saved.\n",
+                DATA_FILE, overlay_path);
+        return 0;
+    }
+
+    g_legacy_progress_pending = 0;
+    fprintf(stderr, "Note: Moved the progress stored in %s to '%s'.\n", DATA_FILE, overlay_path);
+    return 1;
+}
+
+int save_progress_to_json()
+{
+    if (g_legacy_progress_pending)
+        return migrate_legacy_progress();
+    return write_progress_overlay();
+}
+
+void save_data_to_json()
+{
+    if (g_legacy_progress_pending)
+    {
+        migrate_legacy_progress();
+        return;
+    }
+    save_catalog_to_json();
+    write_progress_overlay();
+}
+
+unsigned long allocate_entry_id()
+{
+    return g_next_entry_id++;
 }
 
 // Function to get the course root directory
@@ -1,12 +1,28 @@
 #ifndef DATA_MANAGER_H
 #define DATA_MANAGER_H
 
-// Loads all data (course name and video list) from the JSON file.
+#include <stddef.h>
+
+// Loads the shared media catalog (course name and video list) and applies
+// the current user's progress overlay on top of it. Never writes any file.
 void load_data_from_json();
 
-// Saves all the collected video information into a JSON file.
+// Saves the shared media catalog and the current user's progress overlay.
 void save_data_to_json();
 
+// Saves only the current user's progress overlay (watched seconds and stats).
+// The first save of a user without an overlay also removes the progress of a
+// pre-overlay data file from the catalog. Returns 0 if nothing could be
+// saved (already reported).
+int save_progress_to_json();
+
+// Hands out the next compact catalog entry id.
+unsigned long allocate_entry_id();
+
+// Builds the path of a per-user file (<root>/.mirava_progress/<user><suffix>)
+// and creates its directory. Returns 0 if the directory could not be created.
+int prepare_user_file_path(char *buffer, size_t size, const char *suffix);
+
 // Gets the course root directory path
 const char* get_course_root_dir();
 
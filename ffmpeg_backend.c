@@ -0,0 +1,159 @@
+#define _DEFAULT_SOURCE
+#include "ffmpeg_backend.h"
+#include "video_list.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <libavformat/avformat.h>
+#include <libavutil/avutil.h>
+#include <libavutil/dict.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HMODULE lib_handle;
+#define lib_open(name) LoadLibraryA(name)
+#define lib_symbol(handle, name) ((void *)GetProcAddress(handle, name))
+#define lib_close(handle) FreeLibrary(handle)
+#else
+#include <dlfcn.h>
+typedef void *lib_handle;
+#define lib_open(name) dlopen(name, RTLD_NOW | RTLD_LOCAL)
+#define lib_symbol(handle, name) dlsym(handle, name)
+#define lib_close(handle) dlclose(handle)
+#endif
+
+// Only the sonames matching the headers we were built against are tried, so the
+// AVFormatContext layout we read is guaranteed to match the loaded library.
+#define AVFORMAT_MAJOR AV_STRINGIFY(LIBAVFORMAT_VERSION_MAJOR)
+#define AVUTIL_MAJOR AV_STRINGIFY(LIBAVUTIL_VERSION_MAJOR)
+
+#if defined(_WIN32)
+static const char *avutil_names[] = { "avutil-" AVUTIL_MAJOR ".dll", NULL };
+static const char *avformat_names[] = { "avformat-" AVFORMAT_MAJOR ".dll", NULL };
+#elif defined(__APPLE__)
+static const char *avutil_names[] = {
+    "libavutil." AVUTIL_MAJOR ".dylib",
+    "/opt/homebrew/lib/libavutil." AVUTIL_MAJOR ".dylib",
+    "/usr/local/lib/libavutil." AVUTIL_MAJOR ".dylib",
+    NULL
+};
+static const char *avformat_names[] = {
+    "libavformat." AVFORMAT_MAJOR ".dylib",
+    "/opt/homebrew/lib/libavformat." AVFORMAT_MAJOR ".dylib",
+    "/usr/local/lib/libavformat." AVFORMAT_MAJOR ".dylib",
+    NULL
+};
+#else
+static const char *avutil_names[] = { "libavutil.so." AVUTIL_MAJOR, NULL };
+static const char *avformat_names[] = { "libavformat.so." AVFORMAT_MAJOR, NULL };
+#endif
+
+typedef void (*log_set_level_fn)(int);
+typedef int (*open_input_fn)(AVFormatContext **, const char *, const AVInputFormat *, AVDictionary **);
+typedef int (*find_stream_info_fn)(AVFormatContext *, AVDictionary **);
+typedef void (*close_input_fn)(AVFormatContext **);
+typedef AVDictionaryEntry *(*dict_get_fn)(const AVDictionary *, const char *, const AVDictionaryEntry *, int);
+
+static struct {
+    int state; // 0 = not tried yet, 1 = loaded, -1 = unavailable
+    lib_handle avutil;
+    lib_handle avformat;
+    log_set_level_fn log_set_level;
+    dict_get_fn dict_get;
+    open_input_fn open_input;
+    find_stream_info_fn find_stream_info;
+    close_input_fn close_input;
+} g_ffmpeg;
+
+static lib_handle open_first(const char **names)
+{
+    for (size_t i = 0; names[i]; i++)
+    {
+        lib_handle handle = lib_open(names[i]);
+        if (handle)
+            return handle;
+    }
+    return NULL;
+}
+
+int ffmpeg_backend_load()
+{
+    if (g_ffmpeg.state != 0)
+        return g_ffmpeg.state == 1;
+
+    g_ffmpeg.state = -1;
+    g_ffmpeg.avutil = open_first(avutil_names);
+    g_ffmpeg.avformat = g_ffmpeg.avutil ? open_first(avformat_names) : NULL;
+    if (!g_ffmpeg.avformat)
+    {
+        ffmpeg_backend_unload();
+        g_ffmpeg.state = -1;
+        return 0;
+    }
+
+    g_ffmpeg.log_set_level = (log_set_level_fn)lib_symbol(g_ffmpeg.avutil, "av_log_set_level");
+    g_ffmpeg.dict_get = (dict_get_fn)lib_symbol(g_ffmpeg.avutil, "av_dict_get");
+    g_ffmpeg.open_input = (open_input_fn)lib_symbol(g_ffmpeg.avformat, "avformat_open_input");
+    g_ffmpeg.find_stream_info = (find_stream_info_fn)lib_symbol(g_ffmpeg.avformat, "avformat_find_stream_info");
+    g_ffmpeg.close_input = (close_input_fn)lib_symbol(g_ffmpeg.avformat, "avformat_close_input");
+
+    if (!g_ffmpeg.log_set_level || !g_ffmpeg.dict_get || !g_ffmpeg.open_input || !g_ffmpeg.find_stream_info || !g_ffmpeg.close_input)
+    {
+        ffmpeg_backend_unload();
+        g_ffmpeg.state = -1;
+        return 0;
+    }
+
+    // Suppress FFmpeg logs for cleaner output
+    g_ffmpeg.log_set_level(AV_LOG_QUIET);
+    g_ffmpeg.state = 1;
+    return 1;
+}
+
+static long long to_seconds(int64_t value, AVRational time_base)
+{
+    if (time_base.den == 0)
+        return 0;
+    return (long long)(value * time_base.num / time_base.den);
+}
+
+long long ffmpeg_get_duration(const char *filepath, ChapterTable *chapters)
+{
+    if (!ffmpeg_backend_load())
+        return -1;
+
+    AVFormatContext *pFormatCtx = NULL;
+    if (g_ffmpeg.open_input(&pFormatCtx, filepath, NULL, NULL) != 0)
+    {
+        return -1;
+    }
+
+    if (g_ffmpeg.find_stream_info(pFormatCtx, NULL) < 0)
+    {
+        g_ffmpeg.close_input(&pFormatCtx);
+        return -2;
+    }
+
+    long long duration = pFormatCtx->duration;
+    for (unsigned int i = 0; chapters && i < pFormatCtx->nb_chapters; i++)
+    {
+        const AVChapter *chapter = pFormatCtx->chapters[i];
+        const AVDictionaryEntry *title = g_ffmpeg.dict_get(chapter->metadata, "title", NULL, 0);
+        add_chapter_to_table(chapters, title ? title->value : "",
+                             to_seconds(chapter->start, chapter->time_base),
+                             to_seconds(chapter->end, chapter->time_base));
+    }
+    g_ffmpeg.close_input(&pFormatCtx);
+
+    return (duration > 0) ? (duration / AV_TIME_BASE) : 0;
+}
+
+void ffmpeg_backend_unload()
+{
+    if (g_ffmpeg.avformat)
+        lib_close(g_ffmpeg.avformat);
+    if (g_ffmpeg.avutil)
+        lib_close(g_ffmpeg.avutil);
+    g_ffmpeg.avformat = NULL;
+    g_ffmpeg.avutil = NULL;
+    g_ffmpeg.state = 0;
+}
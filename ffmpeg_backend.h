@@ -0,0 +1,18 @@
+#ifndef FFMPEG_BACKEND_H
+#define FFMPEG_BACKEND_H
+
+#include "types.h"
+
+// Loads libavformat/libavutil on first use. Returns 1 if FFmpeg is usable.
+// Commands that never probe a file never pay for loading the libraries.
+int ffmpeg_backend_load();
+
+// Gets the duration of a media file in seconds using the loaded FFmpeg, and
+// its chapter table if chapters is not NULL.
+// Returns -1 if the file could not be opened, -2 if it could not be probed.
+long long ffmpeg_get_duration(const char *filepath, ChapterTable *chapters);
+
+// Unloads the FFmpeg libraries if they were loaded.
+void ffmpeg_backend_unload();
+
+#endif // FFMPEG_BACKEND_H
@@ -1,10 +1,15 @@
 #define _DEFAULT_SOURCE
+#define _FILE_OFFSET_BITS 64
 #include "file_utils.h"
+#include "container_parser.h"
+#ifndef MIRAVA_NO_FFMPEG
+#include "ffmpeg_backend.h"
+#endif
 #include <stdio.h>
 #include <string.h>
 #include <strings.h>
-#include <libavformat/avformat.h>
-#include <libavutil/avutil.h>
+#include <stdint.h>
+#include <sys/types.h>
 
 int is_video_file(const char *filepath)
 {
@@ -53,22 +58,72 @@ int is_video_file(const char *filepath)
     return 0;
 }
 
-long long get_duration_in_seconds(const char *filepath)
+long long get_duration_in_seconds(const char *filepath, ChapterTable *chapters)
 {
-    AVFormatContext *pFormatCtx = NULL;
-    if (avformat_open_input(&pFormatCtx, filepath, NULL, NULL) != 0)
+#ifndef MIRAVA_NO_FFMPEG
+    // FFmpeg is loaded on the first probe only; fall back to the built-in
+    // parsers when it is not installed or cannot read the file.
+    if (ffmpeg_backend_load())
     {
-        return -1;
+        long long duration = ffmpeg_get_duration(filepath, chapters);
+        if (duration >= 0)
+            return duration;
     }
+#endif
+    return parse_container_duration(filepath, chapters);
+}
+
+#define FINGERPRINT_SAMPLE_SIZE (64 * 1024)
 
-    if (avformat_find_stream_info(pFormatCtx, NULL) < 0)
+// FNV-1a, 64-bit
+static uint64_t fnv1a_update(uint64_t hash, const unsigned char *data, size_t length)
+{
+    for (size_t i = 0; i < length; i++)
     {
-        avformat_close_input(&pFormatCtx);
-        return -2;
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
     }
+    return hash;
+}
+
+int compute_file_fingerprint(const char *filepath, char out[17])
+{
+    out[0] = '\0';
+    FILE *f = fopen(filepath, "rb");
+    if (!f)
+        return 0;
 
-    long long duration = pFormatCtx->duration;
-    avformat_close_input(&pFormatCtx);
+    static unsigned char buffer[FINGERPRINT_SAMPLE_SIZE];
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    off_t size = -1;
+    int ok = 0;
+
+    if (fseeko(f, 0, SEEK_END) == 0 && (size = ftello(f)) >= 0 && fseeko(f, 0, SEEK_SET) == 0)
+    {
+        unsigned char size_bytes[8];
+        for (int i = 0; i < 8; i++)
+            size_bytes[i] = (unsigned char)((uint64_t)size >> (8 * i));
+        hash = fnv1a_update(hash, size_bytes, sizeof(size_bytes));
+
+        size_t n = fread(buffer, 1, sizeof(buffer), f);
+        hash = fnv1a_update(hash, buffer, n);
+
+        // Files up to two samples long were already covered by the first read
+        if (size > 2 * FINGERPRINT_SAMPLE_SIZE && fseeko(f, -FINGERPRINT_SAMPLE_SIZE, SEEK_END) == 0)
+        {
+            n = fread(buffer, 1, sizeof(buffer), f);
+            hash = fnv1a_update(hash, buffer, n);
+        }
+        else if (size > FINGERPRINT_SAMPLE_SIZE)
+        {
+            n = fread(buffer, 1, sizeof(buffer), f);
+            hash = fnv1a_update(hash, buffer, n);
+        }
+        ok = !ferror(f);
+    }
+    fclose(f);
 
-    return (duration > 0) ? (duration / AV_TIME_BASE) : 0;
+    if (ok)
+        snprintf(out, 17, "%016llx", (unsigned long long)hash);
+    return ok;
 }
@@ -1,10 +1,18 @@
 #ifndef FILE_UTILS_H
 #define FILE_UTILS_H
 
+#include "types.h"
+
 // Checks if a file is a video by executing the 'file' command.
 int is_video_file(const char *filepath);
 
-// Gets the duration of a video file in seconds using FFmpeg.
-long long get_duration_in_seconds(const char *filepath);
+// Gets the duration of a video file in seconds, using FFmpeg when it is
+// available and the built-in container parsers otherwise. If chapters is not
+// NULL, the chapter table found by the same probe is stored in it.
+long long get_duration_in_seconds(const char *filepath, ChapterTable *chapters);
+
+// Computes a content fingerprint of a file from its size and its first and
+// last 64 KiB, written as 16 hex characters. Returns 0 if it could not be read.
+int compute_file_fingerprint(const char *filepath, char out[17]);
 
 #endif // FILE_UTILS_H
@@ -0,0 +1,178 @@
+#define _DEFAULT_SOURCE
+#include "history.h"
+#include "data_manager.h"
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+
+// Every progress change is appended to the user's log in the progress
+// directory (.mirava_progress/<user>.log) as one line:
+//   <unix_time> <delta_sec> <watched_sec> <path>
+// The log is never read back by mirava itself; the aggregates below are
+// kept up to date as events are written.
+static WatchStats g_watch_stats;
+
+// Days since 1970-01-01 for a proleptic Gregorian date.
+static long long days_from_civil(long long y, int m, int d)
+{
+    y -= m <= 2;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yoe = y - era * 400;
+    long long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+long long day_number_from_time(time_t t)
+{
+    struct tm *local = localtime(&t);
+    if (!local)
+    {
+        return (long long)(t / 86400);
+    }
+    return days_from_civil(local->tm_year + 1900LL, local->tm_mon + 1, local->tm_mday);
+}
+
+void date_from_day_number(long long day, int *year, int *month, int *mday)
+{
+    day += 719468;
+    long long era = (day >= 0 ? day : day - 146096) / 146097;
+    long long doe = day - era * 146097;
+    long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long long mp = (5 * doy + 2) / 153;
+    int d = (int)(doy - (153 * mp + 2) / 5 + 1);
+    int m = (int)(mp < 10 ? mp + 3 : mp - 9);
+
+    *year = (int)(yoe + era * 400 + (m <= 2));
+    *month = m;
+    *mday = d;
+}
+
+// Opened on the first event and kept open, so batch imports write many
+// events without reopening the log each time.
+static FILE *g_history_log;
+
+static void append_to_log(time_t now, long long delta, const VideoInfo *vid)
+{
+    if (!g_history_log)
+    {
+        char log_path[PATH_MAX];
+        if (prepare_user_file_path(log_path, sizeof(log_path), ".log"))
+        {
+            g_history_log = fopen(log_path, "a");
+        }
+        if (!g_history_log)
+        {
+            fprintf(stderr, "Warning: Could not open history log '%s'.\n", log_path);
+            return;
+        }
+    }
+    fprintf(g_history_log, "%lld %lld %lld %s\n", (long long)now, delta, vid->watched_sec, vid->path);
+}
+
+static void add_watched_seconds(long long day, long long seconds)
+{
+    WatchStats *st = &g_watch_stats;
+
+    if (st->first_day == 0)
+    {
+        memset(st->daily_sec, 0, sizeof(st->daily_sec));
+        st->first_day = day;
+        st->last_day = day;
+        st->current_streak = 1;
+    }
+    else if (day > st->last_day)
+    {
+        // Zero the ring slots of the days that passed without activity
+        long long gap = day - st->last_day;
+        for (long long k = 1; k <= gap && k <= PACE_WINDOW_DAYS; k++)
+        {
+            st->daily_sec[(st->last_day + k) % PACE_WINDOW_DAYS] = 0;
+        }
+        st->current_streak = (gap == 1) ? st->current_streak + 1 : 1;
+        st->last_day = day;
+    }
+    else
+    {
+        // Same day, or the clock went backwards: credit the latest day
+        day = st->last_day;
+    }
+
+    if (st->current_streak > st->longest_streak)
+    {
+        st->longest_streak = st->current_streak;
+    }
+    st->daily_sec[day % PACE_WINDOW_DAYS] += seconds;
+    st->total_sec += seconds;
+}
+
+void record_progress_event(const VideoInfo *vid, long long old_watched_sec)
+{
+    if (!vid || vid->watched_sec == old_watched_sec)
+        return;
+
+    time_t now = time(NULL);
+    long long delta = vid->watched_sec - old_watched_sec;
+    append_to_log(now, delta, vid);
+
+    // Only forward progress on videos with a known duration counts towards
+    // pace; unknown durations use placeholder values (see parse_progress_string).
+    if (delta > 0 && vid->duration_sec > 0)
+    {
+        add_watched_seconds(day_number_from_time(now), delta);
+    }
+}
+
+void summarize_watch_stats(long long today, WatchSummary *summary)
+{
+    const WatchStats *st = &g_watch_stats;
+    memset(summary, 0, sizeof(*summary));
+    summary->total_sec = st->total_sec;
+    summary->longest_streak = st->longest_streak;
+
+    if (st->first_day == 0)
+        return;
+
+    // Sum the days of the window that the ring buffer still holds
+    for (int k = 0; k < PACE_WINDOW_DAYS; k++)
+    {
+        long long day = today - k;
+        if (day <= st->last_day && day > st->last_day - PACE_WINDOW_DAYS)
+        {
+            long long sec = st->daily_sec[day % PACE_WINDOW_DAYS];
+            summary->window_sec += sec;
+            if (k == 0)
+                summary->today_sec = sec;
+        }
+    }
+
+    // Average over the days actually tracked when history is younger than the window
+    long long span = today - st->first_day + 1;
+    if (span > PACE_WINDOW_DAYS)
+        span = PACE_WINDOW_DAYS;
+    if (span < 1)
+        span = 1;
+    summary->pace_sec = summary->window_sec / span;
+
+    summary->current_streak = (today - st->last_day <= 1) ? st->current_streak : 0;
+}
+
+WatchStats* get_watch_stats()
+{
+    return &g_watch_stats;
+}
+
+void reset_watch_stats()
+{
+    memset(&g_watch_stats, 0, sizeof(g_watch_stats));
+}
+
+void close_history_log()
+{
+    if (g_history_log)
+    {
+        fclose(g_history_log);
+        g_history_log = NULL;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+
+#include "types.h"
+#include <time.h>
+
+// A point-in-time view of the watch statistics, relative to a given day.
+typedef struct {
+    long long today_sec;      // Seconds watched today
+    long long window_sec;     // Seconds watched in the last PACE_WINDOW_DAYS days
+    long long pace_sec;       // Moving-average seconds watched per day
+    long long total_sec;      // All watched seconds ever logged
+    int current_streak;       // 0 if the streak was broken before yesterday
+    int longest_streak;
+} WatchSummary;
+
+// Converts a timestamp to a local day number (days since 1970-01-01).
+long long day_number_from_time(time_t t);
+
+// Converts a local day number back to a calendar date.
+void date_from_day_number(long long day, int *year, int *month, int *mday);
+
+// Appends a progress change to the history log and updates the aggregates.
+void record_progress_event(const VideoInfo *vid, long long old_watched_sec);
+
+// Flushes and closes the history log if it was opened.
+void close_history_log();
+
+// Summarizes the aggregates as seen from the given day.
+void summarize_watch_stats(long long today, WatchSummary *summary);
+
+// Gets the aggregates so they can be loaded from and saved to the data file.
+WatchStats* get_watch_stats();
+
+// Clears the in-memory aggregates.
+void reset_watch_stats();
+
+#endif // HISTORY_H
@@ -3,21 +3,84 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <libavformat/avformat.h>
 
 int main(int argc, char *argv[])
 {
-    // Suppress FFmpeg logs for cleaner output
-    av_log_set_level(AV_LOG_QUIET);
-
-    if (argc == 1)
+    if (argc == 1 || strncmp(argv[1], "--", 2) == 0)
     {
-        action_list_and_sync();
+        ListOptions options;
+        if (!parse_list_options(argc, argv, 1, &options))
+        {
+            show_help();
+            return 1;
+        }
+        action_list_and_sync(&options);
+    }
+    else if (strcmp(argv[1], "list") == 0)
+    {
+        ListOptions options;
+        if (!parse_list_options(argc, argv, 2, &options))
+        {
+            show_help();
+            return 1;
+        }
+        action_list_cached(&options);
     }
     else if (strcmp(argv[1], "help") == 0)
     {
         show_help();
     }
+    else if (strcmp(argv[1], "stats") == 0)
+    {
+        action_show_stats();
+    }
+    else if (strcmp(argv[1], "chapters") == 0)
+    {
+        if (argc != 3)
+        {
+            fprintf(stderr, "Error: 'chapters' command requires a video number.\n");
+            show_help();
+            return 1;
+        }
+        action_show_chapters(atoi(argv[2]));
+    }
+    else if (strcmp(argv[1], "import-mpv") == 0)
+    {
+        if (argc > 3)
+        {
+            fprintf(stderr, "Error: 'import-mpv' command takes at most one directory.\n");
+            show_help();
+            return 1;
+        }
+        action_import_mpv(argc == 3 ? argv[2] : NULL);
+    }
+    else if (strcmp(argv[1], "export") == 0)
+    {
+        if (argc > 3)
+        {
+            fprintf(stderr, "Error: 'export' command takes at most one output file.\n");
+            show_help();
+            return 1;
+        }
+        action_export_progress(argc == 3 ? argv[2] : NULL);
+    }
+    else if (strcmp(argv[1], "import") == 0)
+    {
+        if (argc == 3)
+        {
+            action_import_progress(argv[2], NULL);
+        }
+        else if (argc == 5 && strcmp(argv[3], "--policy") == 0)
+        {
+            action_import_progress(argv[2], argv[4]);
+        }
+        else
+        {
+            fprintf(stderr, "Error: 'import' command requires a snapshot file and an optional '--policy max|lww'.\n");
+            show_help();
+            return 1;
+        }
+    }
     else if (strcmp(argv[1], "set") == 0)
     {
         if (argc != 4)
@@ -0,0 +1,10 @@
+#ifndef MD5_H
+#define MD5_H
+
+#include <stddef.h>
+
+// Computes the MD5 digest of a buffer and writes it as 32 uppercase hex
+// characters plus a terminating NUL (the form mpv uses for watch_later names).
+void md5_hex_upper(const void *data, size_t length, char out[33]);
+
+#endif // MD5_H
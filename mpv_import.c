@@ -0,0 +1,138 @@
+#define _DEFAULT_SOURCE
+#include "mpv_import.h"
+#include "globals.h"
+#include "history.h"
+#include "md5.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <limits.h>
+#include <time.h>
+
+// mpv names each watch_later file after the MD5 of the media path it
+// played (uppercase hex). We hash every known video once, sort the hashes
+// and resolve the directory listing against them, so the cost is one
+// directory scan plus one small read per matching file.
+typedef struct {
+    char hash[33];
+    size_t index;
+} PathHash;
+
+static int compare_path_hash(const void *a, const void *b)
+{
+    return strcmp(((const PathHash *)a)->hash, ((const PathHash *)b)->hash);
+}
+
+static int is_directory(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+int find_mpv_watch_later_dir(char *buffer, size_t size)
+{
+    const char *state_home = getenv("XDG_STATE_HOME");
+    const char *home = getenv("HOME");
+
+    if (state_home && state_home[0])
+    {
+        snprintf(buffer, size, "%s/mpv/watch_later", state_home);
+        if (is_directory(buffer))
+            return 1;
+    }
+    if (home && home[0])
+    {
+        snprintf(buffer, size, "%s/.local/state/mpv/watch_later", home);
+        if (is_directory(buffer))
+            return 1;
+        snprintf(buffer, size, "%s/.config/mpv/watch_later", home);
+        if (is_directory(buffer))
+            return 1;
+    }
+    return 0;
+}
+
+// Reads the "start=<seconds>" line of a watch_later file. Returns -1 if missing.
+static long long read_start_position(const char *file_path)
+{
+    FILE *f = fopen(file_path, "r");
+    if (!f)
+        return -1;
+
+    char line[512];
+    long long start = -1;
+    while (fgets(line, sizeof(line), f))
+    {
+        if (strncmp(line, "start=", 6) == 0)
+        {
+            double seconds = strtod(line + 6, NULL);
+            start = (seconds > 0) ? (long long)seconds : 0;
+            break;
+        }
+    }
+    fclose(f);
+    return start;
+}
+
+long import_mpv_positions(const char *watch_later_dir, const char *course_root)
+{
+    DIR *dir = opendir(watch_later_dir);
+    if (!dir)
+        return -1;
+
+    PathHash *hashes = malloc((g_video_count ? g_video_count : 1) * sizeof(PathHash));
+    if (!hashes)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for mpv import.\n");
+        closedir(dir);
+        return -1;
+    }
+
+    // mpv hashes the absolute path of the file it played
+    char full_path[PATH_MAX];
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        int length = snprintf(full_path, sizeof(full_path), "%s/%s", course_root, g_video_list[i]->path);
+        if (length < 0 || (size_t)length >= sizeof(full_path))
+            length = 0; // Too long to have been played from this root; cannot match
+        md5_hex_upper(full_path, (size_t)length, hashes[i].hash);
+        hashes[i].index = i;
+    }
+    qsort(hashes, g_video_count, sizeof(PathHash), compare_path_hash);
+
+    long updated = 0;
+    time_t now = time(NULL);
+    struct dirent *dp;
+    while ((dp = readdir(dir)) != NULL)
+    {
+        if (strlen(dp->d_name) != 32)
+            continue;
+
+        PathHash key;
+        memcpy(key.hash, dp->d_name, sizeof(key.hash));
+        PathHash *match = bsearch(&key, hashes, g_video_count, sizeof(PathHash), compare_path_hash);
+        if (!match)
+            continue;
+
+        snprintf(full_path, sizeof(full_path), "%s/%s", watch_later_dir, dp->d_name);
+        long long start = read_start_position(full_path);
+        VideoInfo *vid = g_video_list[match->index];
+        if (vid->duration_sec > 0 && start > vid->duration_sec)
+            start = vid->duration_sec;
+
+        if (start > vid->watched_sec)
+        {
+            long long old_watched_sec = vid->watched_sec;
+            vid->watched_sec = start;
+            vid->updated_at = (long long)now;
+            record_progress_event(vid, old_watched_sec);
+            updated++;
+        }
+    }
+
+    closedir(dir);
+    free(hashes);
+    return updated;
+}
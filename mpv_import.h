@@ -0,0 +1,16 @@
+#ifndef MPV_IMPORT_H
+#define MPV_IMPORT_H
+
+#include <stddef.h>
+
+// Finds mpv's watch_later directory: $XDG_STATE_HOME/mpv/watch_later,
+// ~/.local/state/mpv/watch_later, or the pre-0.34 ~/.config/mpv/watch_later.
+// Returns 1 and fills buffer if one of them exists.
+int find_mpv_watch_later_dir(char *buffer, size_t size);
+
+// Applies the resume positions in watch_later_dir to the global video list.
+// Progress is only ever moved forward. Returns the number of updated videos,
+// or -1 if the directory could not be read.
+long import_mpv_positions(const char *watch_later_dir, const char *course_root);
+
+#endif // MPV_IMPORT_H
@@ -0,0 +1,81 @@
+#define _DEFAULT_SOURCE
+#include "output_buffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <unistd.h>
+
+static int outbuf_reserve(OutputBuffer *buffer, size_t extra)
+{
+    if (buffer->length + extra <= buffer->capacity)
+        return 1;
+
+    size_t new_capacity = buffer->capacity == 0 ? 4096 : buffer->capacity;
+    while (new_capacity < buffer->length + extra)
+        new_capacity *= 2;
+
+    char *new_data = realloc(buffer->data, new_capacity);
+    if (!new_data)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for output.\n");
+        return 0;
+    }
+    buffer->data = new_data;
+    buffer->capacity = new_capacity;
+    return 1;
+}
+
+int outbuf_append(OutputBuffer *buffer, const char *data, size_t length)
+{
+    if (!outbuf_reserve(buffer, length))
+        return 0;
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return 1;
+}
+
+int outbuf_printf(OutputBuffer *buffer, const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    int needed = vsnprintf(NULL, 0, format, args);
+    va_end(args);
+    if (needed < 0 || !outbuf_reserve(buffer, (size_t)needed + 1))
+        return 0;
+
+    va_start(args, format);
+    vsnprintf(buffer->data + buffer->length, (size_t)needed + 1, format, args);
+    va_end(args);
+    buffer->length += (size_t)needed;
+    return 1;
+}
+
+int outbuf_write(OutputBuffer *buffer, int fd)
+{
+    // Anything already printed through stdio must come first
+    fflush(stdout);
+
+    size_t written = 0;
+    while (written < buffer->length)
+    {
+        ssize_t n = write(fd, buffer->data + written, buffer->length - written);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return 0;
+        }
+        written += (size_t)n;
+    }
+    return 1;
+}
+
+void outbuf_free(OutputBuffer *buffer)
+{
+    free(buffer->data);
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
@@ -0,0 +1,27 @@
+#ifndef OUTPUT_BUFFER_H
+#define OUTPUT_BUFFER_H
+
+#include <stddef.h>
+
+// A growable byte buffer that collects output so it can be written with a
+// single write() instead of one stdio call per line.
+typedef struct {
+    char *data;
+    size_t length;
+    size_t capacity;
+} OutputBuffer;
+
+// Appends raw bytes. Returns 0 if memory could not be allocated.
+int outbuf_append(OutputBuffer *buffer, const char *data, size_t length);
+
+// Appends printf-style formatted text. Returns 0 on failure.
+int outbuf_printf(OutputBuffer *buffer, const char *format, ...);
+
+// Flushes stdio and writes the whole buffer to a file descriptor.
+// Returns 0 on write errors.
+int outbuf_write(OutputBuffer *buffer, int fd);
+
+// Frees the buffer and leaves it empty.
+void outbuf_free(OutputBuffer *buffer);
+
+#endif // OUTPUT_BUFFER_H
@@ -0,0 +1,266 @@
+#define _DEFAULT_SOURCE
+#include "snapshot.h"
+#include "globals.h"
+#include <stdlib.h>
+#include <string.h>
+
+// Snapshot format: a header line, then one line per video sorted by path:
+//   mirava-snapshot 1
+//   <watched_sec>\t<updated_at>\t<fingerprint or ->\t<relative path>
+// Both sides are merged as sorted lists in a single linear pass, so no
+// per-entry lookups into the video list are needed.
+#define SNAPSHOT_HEADER "mirava-snapshot 1"
+
+typedef struct {
+    const char *path;        // Points into the snapshot buffer
+    const char *fingerprint; // Empty if the exporting side had none
+    long long watched_sec;
+    long long updated_at;
+    int matched;
+} SnapshotEntry;
+
+static int compare_entry_path(const void *a, const void *b)
+{
+    return strcmp(((const SnapshotEntry *)a)->path, ((const SnapshotEntry *)b)->path);
+}
+
+static int compare_entry_fingerprint(const void *a, const void *b)
+{
+    return strcmp(((const SnapshotEntry *)a)->fingerprint, ((const SnapshotEntry *)b)->fingerprint);
+}
+
+static int compare_video_path(const void *a, const void *b)
+{
+    return strcmp((*(VideoInfo *const *)a)->path, (*(VideoInfo *const *)b)->path);
+}
+
+static int compare_video_fingerprint(const void *a, const void *b)
+{
+    return strcmp((*(VideoInfo *const *)a)->fingerprint, (*(VideoInfo *const *)b)->fingerprint);
+}
+
+// Returns the global video list sorted by path (the list itself keeps its order)
+static VideoInfo** sorted_videos_by_path()
+{
+    VideoInfo **sorted = malloc((g_video_count ? g_video_count : 1) * sizeof(VideoInfo *));
+    if (!sorted)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for snapshot.\n");
+        return NULL;
+    }
+    memcpy(sorted, g_video_list, g_video_count * sizeof(VideoInfo *));
+    qsort(sorted, g_video_count, sizeof(VideoInfo *), compare_video_path);
+    return sorted;
+}
+
+int export_snapshot(FILE *out)
+{
+    VideoInfo **sorted = sorted_videos_by_path();
+    if (!sorted)
+        return 0;
+
+    fprintf(out, "%s\n", SNAPSHOT_HEADER);
+    for (size_t i = 0; i < g_video_count; i++)
+    {
+        const VideoInfo *vid = sorted[i];
+        fprintf(out, "%lld\t%lld\t%s\t%s\n", vid->watched_sec, vid->updated_at,
+                vid->fingerprint[0] ? vid->fingerprint : "-", vid->path);
+    }
+
+    free(sorted);
+    return !ferror(out);
+}
+
+// Reads the whole file and splits it in place into entries.
+static char* read_snapshot(const char *snapshot_path, SnapshotEntry **entries_out, size_t *count_out)
+{
+    FILE *f = fopen(snapshot_path, "rb");
+    if (!f)
+        return NULL;
+
+    size_t capacity = 1 << 16, length = 0;
+    char *buffer = malloc(capacity + 1);
+    while (buffer)
+    {
+        length += fread(buffer + length, 1, capacity - length, f);
+        if (length < capacity)
+            break;
+        capacity *= 2;
+        char *grown = realloc(buffer, capacity + 1);
+        if (!grown)
+        {
+            free(buffer);
+            buffer = NULL;
+            break;
+        }
+        buffer = grown;
+    }
+    fclose(f);
+    if (!buffer)
+        return NULL;
+    buffer[length] = '\0';
+
+    size_t header_length = strlen(SNAPSHOT_HEADER);
+    if (strncmp(buffer, SNAPSHOT_HEADER, header_length) != 0 ||
+        (buffer[header_length] != '\n' && buffer[header_length] != '\r'))
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    size_t lines = 0;
+    for (size_t i = 0; i < length; i++)
+        lines += (buffer[i] == '\n');
+
+    SnapshotEntry *entries = malloc((lines ? lines : 1) * sizeof(SnapshotEntry));
+    if (!entries)
+    {
+        free(buffer);
+        return NULL;
+    }
+
+    // A header without a line break is a snapshot without entries
+    size_t count = 0;
+    char *line = strchr(buffer, '\n');
+    if (line)
+        line++;
+    while (line && *line)
+    {
+        char *end = strchr(line, '\n');
+        if (end)
+        {
+            *end = '\0';
+            if (end > line && end[-1] == '\r')
+                end[-1] = '\0';
+        }
+
+        char *fields[4] = { line, NULL, NULL, NULL };
+        for (int k = 1; k < 4 && fields[k - 1]; k++)
+        {
+            fields[k] = strchr(fields[k - 1], '\t');
+            if (fields[k])
+                *fields[k]++ = '\0';
+        }
+
+        if (fields[3] && fields[3][0])
+        {
+            SnapshotEntry *entry = &entries[count++];
+            entry->watched_sec = atoll(fields[0]);
+            entry->updated_at = atoll(fields[1]);
+            entry->fingerprint = strcmp(fields[2], "-") == 0 ? "" : fields[2];
+            entry->path = fields[3];
+            entry->matched = 0;
+        }
+        line = end ? end + 1 : NULL;
+    }
+
+    *entries_out = entries;
+    *count_out = count;
+    return buffer;
+}
+
+// Applies one snapshot entry to a local video. Returns 1 if progress changed.
+static int merge_entry(VideoInfo *vid, const SnapshotEntry *entry, MergePolicy policy)
+{
+    long long watched = entry->watched_sec;
+    if (vid->duration_sec > 0 && watched > vid->duration_sec)
+        watched = vid->duration_sec;
+
+    if (policy == MERGE_LAST_WRITER_WINS ? entry->updated_at <= vid->updated_at
+                                         : watched <= vid->watched_sec)
+        return 0;
+
+    int changed = (watched != vid->watched_sec);
+    vid->watched_sec = watched;
+    if (entry->updated_at > vid->updated_at)
+        vid->updated_at = entry->updated_at;
+    return changed;
+}
+
+// Linear merge of two lists sorted by the same key. Unmatched local videos
+// are compacted to the front of `videos` and their count is returned.
+static size_t merge_sorted(VideoInfo **videos, size_t video_count, SnapshotEntry *entries, size_t entry_count,
+                           int by_fingerprint, MergePolicy policy, size_t *matched, size_t *updated)
+{
+    size_t i = 0, j = 0, unmatched = 0;
+    while (i < video_count)
+    {
+        int cmp = -1;
+        if (j < entry_count)
+        {
+            cmp = by_fingerprint ? strcmp(videos[i]->fingerprint, entries[j].fingerprint)
+                                 : strcmp(videos[i]->path, entries[j].path);
+        }
+
+        if (cmp == 0)
+        {
+            *updated += merge_entry(videos[i], &entries[j], policy);
+            entries[j].matched = 1;
+            (*matched)++;
+            i++;
+            j++;
+        }
+        else if (cmp < 0)
+        {
+            videos[unmatched++] = videos[i++];
+        }
+        else
+        {
+            j++;
+        }
+    }
+    return unmatched;
+}
+
+int merge_snapshot(const char *snapshot_path, MergePolicy policy, MergeReport *report)
+{
+    SnapshotEntry *entries = NULL;
+    size_t entry_count = 0;
+    char *buffer = read_snapshot(snapshot_path, &entries, &entry_count);
+    if (!buffer)
+        return 0;
+
+    memset(report, 0, sizeof(*report));
+    report->entries = entry_count;
+
+    VideoInfo **videos = sorted_videos_by_path();
+    if (!videos)
+    {
+        free(entries);
+        free(buffer);
+        return 0;
+    }
+
+    // Exported snapshots are already sorted; only sort foreign ones
+    for (size_t k = 1; k < entry_count; k++)
+    {
+        if (strcmp(entries[k - 1].path, entries[k].path) > 0)
+        {
+            qsort(entries, entry_count, sizeof(SnapshotEntry), compare_entry_path);
+            break;
+        }
+    }
+
+    size_t remaining = merge_sorted(videos, g_video_count, entries, entry_count, 0, policy,
+                                    &report->matched_by_path, &report->updated);
+
+    // Files renamed or moved on one side: match what is left by content fingerprint
+    size_t leftover = 0;
+    for (size_t k = 0; k < entry_count; k++)
+    {
+        if (!entries[k].matched && entries[k].fingerprint[0])
+            entries[leftover++] = entries[k];
+    }
+    if (remaining > 0 && leftover > 0)
+    {
+        qsort(videos, remaining, sizeof(VideoInfo *), compare_video_fingerprint);
+        qsort(entries, leftover, sizeof(SnapshotEntry), compare_entry_fingerprint);
+        merge_sorted(videos, remaining, entries, leftover, 1, policy,
+                     &report->matched_by_fingerprint, &report->updated);
+    }
+
+    free(videos);
+    free(entries);
+    free(buffer);
+    return 1;
+}
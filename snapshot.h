@@ -0,0 +1,29 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+
+// How a snapshot entry is merged into local progress.
+typedef enum {
+    MERGE_MAX_WATCHED,     // Keep whichever side has watched further
+    MERGE_LAST_WRITER_WINS // Keep whichever side was updated last
+} MergePolicy;
+
+// Counts reported by merge_snapshot().
+typedef struct {
+    size_t entries;            // Entries read from the snapshot
+    size_t matched_by_path;
+    size_t matched_by_fingerprint;
+    size_t updated;            // Local videos whose progress changed
+} MergeReport;
+
+// Writes the current user's progress as a snapshot, sorted by path.
+// Returns 0 on write errors.
+int export_snapshot(FILE *out);
+
+// Merges a snapshot file into the global video list. Entries are matched by
+// relative path first, then by content fingerprint. Returns 0 if the file
+// could not be read or is not a snapshot.
+int merge_snapshot(const char *snapshot_path, MergePolicy policy, MergeReport *report);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,78 @@
+#!/bin/sh
+# Checks 'mirava import-mpv' against a fixture course and watch_later
+# directory. Usage: tests/mpv_import_test.sh [path/to/mirava]
+set -eu
+
+MIRAVA=$(cd "$(dirname "${1:-./mirava}")" && pwd -P)/$(basename "${1:-./mirava}")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+COURSE="$WORK/course"
+WATCH_LATER="$WORK/watch_later"
+mkdir -p "$COURSE/part 1" "$WATCH_LATER"
+COURSE=$(cd "$COURSE" && pwd -P)
+
+# mpv names watch_later files after the uppercase MD5 of the absolute path
+mpv_hash()
+{
+    if command -v md5sum >/dev/null 2>&1; then
+        printf '%s' "$1" | md5sum | cut -c1-32 | tr 'a-f' 'A-F'
+    else
+        md5 -q -s "$1" | tr 'a-f' 'A-F'
+    fi
+}
+
+watch_later()
+{
+    printf '# %s\nstart=%s\n' "$2" "$3" > "$WATCH_LATER/$1"
+}
+
+# The catalog and overlay are written directly, so no media files are needed
+cat > "$COURSE/.mirava_data.json" <<JSON
+{"course_name": "mpv fixture", "next_id": 6, "videos": [
+  {"id": 1, "path": "part 1/forward.mp4", "duration_sec": 600},
+  {"id": 2, "path": "part 1/behind.mp4", "duration_sec": 600},
+  {"id": 3, "path": "part 1/clamped.mp4", "duration_sec": 600},
+  {"id": 4, "path": "part 1/other_names.mp4", "duration_sec": 600},
+  {"id": 5, "path": "untouched.mp4", "duration_sec": 600}]}
+JSON
+mkdir "$COURSE/.mirava_progress"
+printf '{"watched": {"1": [100, 0], "2": [500, 0]}}' > "$COURSE/.mirava_progress/test.json"
+
+watch_later "$(mpv_hash "$COURSE/part 1/forward.mp4")" forward 300.750
+watch_later "$(mpv_hash "$COURSE/part 1/behind.mp4")" behind 200
+watch_later "$(mpv_hash "$COURSE/part 1/clamped.mp4")" clamped 9000
+# Names that must not match: another path, a suffixed hash, a lowercase hash
+watch_later "$(mpv_hash "$COURSE/part 1/missing.mp4")" missing 100
+watch_later "$(mpv_hash "$COURSE/part 1/other_names.mp4").bak" suffixed 100
+watch_later "$(mpv_hash "$COURSE/part 1/other_names.mp4" | tr 'A-F' 'a-f')" lowercase 100
+
+failures=0
+check()
+{
+    if [ "$2" = "$3" ]; then
+        echo "ok   - $1"
+    else
+        echo "FAIL - $1: expected '$3', got '$2'"
+        failures=$((failures + 1))
+    fi
+}
+
+cd "$COURSE"
+output=$(MIRAVA_USER=test "$MIRAVA" import-mpv "$WATCH_LATER")
+check "reports the updated videos" "$output" "Imported 2 resume positions from '$WATCH_LATER'."
+
+watched()
+{
+    MIRAVA_USER=test "$MIRAVA" list --format tsv | awk -F '\t' -v path="$1" '$2 == path { print $4 }'
+}
+check "moves progress forward" "$(watched "part 1/forward.mp4")" 300
+check "never moves progress back" "$(watched "part 1/behind.mp4")" 500
+check "clamps to the duration" "$(watched "part 1/clamped.mp4")" 600
+check "ignores names that are not 32 uppercase hex digits of a course path" "$(watched "part 1/other_names.mp4")" 0
+check "leaves videos without a watch_later file alone" "$(watched "untouched.mp4")" 0
+
+output=$(MIRAVA_USER=test "$MIRAVA" import-mpv "$WATCH_LATER")
+check "a second import changes nothing" "$output" "Imported 0 resume positions from '$WATCH_LATER'."
+
+[ "$failures" -eq 0 ]
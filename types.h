@@ -1,12 +1,49 @@
 #ifndef TYPES_H
 #define TYPES_H
 
+// Number of days kept in the rolling daily watch-time window.
+#define PACE_WINDOW_DAYS 7
+
+#include <stddef.h>
+
+// A single chapter of a video, as read from the container.
+typedef struct {
+    char *title;
+    long long start_sec;
+    long long end_sec;
+} ChapterInfo;
+
+// The chapter table of a video, in playback order.
+typedef struct {
+    ChapterInfo *items;
+    size_t count;
+} ChapterTable;
+
 // A structure to hold all information about a single video file.
+// Everything except watched_sec and updated_at lives in the shared media
+// catalog; those two come from the current user's progress overlay.
 typedef struct {
+    unsigned long id;      // Compact catalog entry id, stable across syncs
     char *path;
     long long duration_sec;
     long long watched_sec;
+    long long updated_at;  // Unix time of the last change to watched_sec, 0 if unknown
+    ChapterTable chapters; // Cached from the last probe, empty if none
+    long long file_size;   // Size and mtime at the last probe; a file whose
+    long long mtime;       // stat still matches is not probed again
+    char fingerprint[17];  // Hex content fingerprint, empty if not computed
     int found_on_disk; // A flag to sync with filesystem
 } VideoInfo;
 
+// Rolling aggregates over the watch-history log. They are updated on every
+// progress change, so reading them never requires replaying the log.
+typedef struct {
+    long long first_day;  // Day number of the first logged event (0 = no history)
+    long long last_day;   // Day number of the most recent logged event
+    long long daily_sec[PACE_WINDOW_DAYS]; // Ring buffer indexed by day % PACE_WINDOW_DAYS
+    long long total_sec;  // All watched seconds ever logged
+    int current_streak;   // Consecutive active days ending at last_day
+    int longest_streak;
+} WatchStats;
+
 #endif // TYPES_H
@@ -1,3 +1,4 @@
+#define _DEFAULT_SOURCE
 #include "video_list.h"
 #include "globals.h" // Include the global declarations
 #include <stdlib.h>
@@ -10,6 +11,24 @@ VideoInfo **g_video_list = NULL;
 size_t g_video_count = 0;
 size_t g_video_capacity = 0;
 
+VideoInfo *create_video_info(const char *path)
+{
+    VideoInfo *video = calloc(1, sizeof(VideoInfo));
+    if (!video)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for video.\n");
+        return NULL;
+    }
+
+    video->path = strdup(path);
+    if (!video->path)
+    {
+        free(video);
+        return NULL;
+    }
+    return video;
+}
+
 void add_video_to_list(VideoInfo *video)
 {
     if (g_video_count >= g_video_capacity)
@@ -62,21 +81,123 @@ void prune_missing_videos()
         }
         else
         {
-            free(g_video_list[i]->path);
-            free(g_video_list[i]);
+            free_video_info(g_video_list[i]);
         }
     }
     g_video_count = new_count;
 }
 
+// Length of the valid UTF-8 sequence at text, 0 if it is invalid, or -1 if it
+// was cut short by the end of the string
+static int utf8_sequence_length(const unsigned char *text)
+{
+    int length;
+    if (text[0] < 0x80)
+        return 1;
+    else if (text[0] >= 0xC2 && text[0] <= 0xDF)
+        length = 2;
+    else if (text[0] >= 0xE0 && text[0] <= 0xEF)
+        length = 3;
+    else if (text[0] >= 0xF0 && text[0] <= 0xF4)
+        length = 4;
+    else
+        return 0;
+
+    for (int i = 1; i < length; i++)
+    {
+        if (text[i] == '\0')
+            return -1;
+        if ((text[i] & 0xC0) != 0x80)
+            return 0;
+    }
+
+    // Overlong forms, UTF-16 surrogates and code points past U+10FFFF
+    if ((text[0] == 0xE0 && text[1] < 0xA0) || (text[0] == 0xED && text[1] >= 0xA0) ||
+        (text[0] == 0xF0 && text[1] < 0x90) || (text[0] == 0xF4 && text[1] >= 0x90))
+        return 0;
+    return length;
+}
+
+char* copy_as_utf8(const char *text, int was_cut)
+{
+    const unsigned char *in = (const unsigned char *)text;
+    char *copy = malloc(strlen(text) * 3 + 1);
+    if (!copy)
+        return NULL;
+
+    char *out = copy;
+    while (*in)
+    {
+        int length = utf8_sequence_length(in);
+        if (length < 0 && was_cut)
+            break;
+        if (length <= 0)
+        {
+            memcpy(out, "\xEF\xBF\xBD", 3);
+            out += 3;
+            in++;
+            continue;
+        }
+        memcpy(out, in, (size_t)length);
+        out += length;
+        in += length;
+    }
+    *out = '\0';
+    return copy;
+}
+
+int add_chapter_to_table(ChapterTable *table, const char *title, long long start_sec, long long end_sec)
+{
+    char *title_copy = copy_as_utf8(title ? title : "", 1);
+    if (!title_copy)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for chapter title.\n");
+        return 0;
+    }
+
+    ChapterInfo *new_items = realloc(table->items, (table->count + 1) * sizeof(ChapterInfo));
+    if (!new_items)
+    {
+        fprintf(stderr, "Error: Failed to allocate memory for chapter table.\n");
+        free(title_copy);
+        return 0;
+    }
+    table->items = new_items;
+
+    ChapterInfo *chapter = &table->items[table->count++];
+    chapter->title = title_copy;
+    chapter->start_sec = start_sec;
+    chapter->end_sec = end_sec;
+    return 1;
+}
+
+void free_chapter_table(ChapterTable *table)
+{
+    for (size_t i = 0; i < table->count; i++)
+    {
+        free(table->items[i].title);
+    }
+    free(table->items);
+    table->items = NULL;
+    table->count = 0;
+}
+
+void free_video_info(VideoInfo *video)
+{
+    if (!video)
+        return;
+    free_chapter_table(&video->chapters);
+    free(video->path);
+    free(video);
+}
+
 void cleanup_video_list()
 {
     if (g_video_list)
     {
         for (size_t i = 0; i < g_video_count; i++)
         {
-            free(g_video_list[i]->path);
-            free(g_video_list[i]);
+            free_video_info(g_video_list[i]);
         }
         free(g_video_list);
         g_video_list = NULL;
@@ -4,6 +4,9 @@
 #include "types.h"
 #include <stddef.h>
 
+// Allocates a video with the given path and all other fields empty.
+VideoInfo* create_video_info(const char *path);
+
 // Adds a new video to the global list.
 void add_video_to_list(VideoInfo *video);
 
@@ -13,6 +16,20 @@ VideoInfo* find_video_by_path(const char *path);
 // Removes videos from the list that were not found on disk.
 void prune_missing_videos();
 
+// Returns a malloc'd copy of text that is valid UTF-8: invalid bytes become
+// U+FFFD. If was_cut is set (text cut at a byte limit), a sequence left
+// incomplete at the end is dropped instead.
+char* copy_as_utf8(const char *text, int was_cut);
+
+// Appends a chapter to a chapter table. The title is copied as valid UTF-8.
+int add_chapter_to_table(ChapterTable *table, const char *title, long long start_sec, long long end_sec);
+
+// Frees the chapters of a chapter table and leaves it empty.
+void free_chapter_table(ChapterTable *table);
+
+// Frees a single video and everything it owns.
+void free_video_info(VideoInfo *video);
+
 // Frees all memory associated with the global video list.
 void cleanup_video_list();
 